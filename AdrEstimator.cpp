@@ -0,0 +1,113 @@
+#include "AdrEstimator.h"
+#include "dot_util.h"
+#include "MTSLog.h"
+
+AdrEstimator adr_estimator;
+
+
+AdrEstimator::AdrEstimator() {
+    reset();
+}
+
+void AdrEstimator::reset() {
+    _linkMargin = INT16_MIN;
+    _linkDatarate = 0;
+    _linkAge = 0;
+    _upCount = 0;
+}
+
+void AdrEstimator::linkCheck(uint8_t margin_db, uint8_t gateways) {
+    if (gateways == 0) {
+        return;
+    }
+
+    _linkMargin = margin_db;
+    _linkDatarate = dot->getTxDataRate();
+    _linkAge = 0;
+}
+
+int16_t AdrEstimator::requiredSnr(uint8_t sf) {
+    // Demodulation floor in dB, 2.5 dB lower for each spreading factor above SF7
+    return -(75 + (int16_t)(sf - lora::SF_7) * 25) / 10;
+}
+
+int16_t AdrEstimator::margin() {
+    uint8_t dr = dot->getTxDataRate();
+
+    if (_linkMargin != INT16_MIN && _linkAge < ADR_ESTIMATOR_LINK_CHECK_AGE) {
+        // Each step faster than the link check costs margin
+        return _linkMargin - ((int16_t)dr - _linkDatarate) * ADR_ESTIMATOR_STEP_DB - ADR_ESTIMATOR_INSTALL_MARGIN;
+    }
+
+    if (dot->getStats().Down == 0) {
+        return INT16_MIN;
+    }
+
+    lora::Datarate datarate = dot->getChannelPlan()->GetDatarate(dr);
+
+    if (datarate.SpreadingFactor < lora::SF_7 || datarate.SpreadingFactor > lora::SF_12) {
+        return INT16_MIN;
+    }
+
+    // SNR is reported in cB
+    return dot->getSnrStats().avg / 10 - requiredSnr(datarate.SpreadingFactor) - ADR_ESTIMATOR_INSTALL_MARGIN;
+}
+
+int8_t AdrEstimator::update() {
+    int16_t m = margin();
+
+    if (_linkAge < UINT8_MAX) {
+        _linkAge++;
+    }
+
+    if (m == INT16_MIN) {
+        return 0;
+    }
+
+    uint8_t dr = dot->getTxDataRate();
+    int8_t steps = 0;
+
+    if (m < 0) {
+        // Out of margin, drop straight to a datarate that has it
+        steps = -((-m + ADR_ESTIMATOR_STEP_DB - 1) / ADR_ESTIMATOR_STEP_DB);
+        _upCount = 0;
+    } else if (m >= ADR_ESTIMATOR_STEP_DB) {
+        if (++_upCount >= ADR_ESTIMATOR_UP_COUNT) {
+            steps = 1;
+            _upCount = 0;
+        }
+    } else {
+        _upCount = 0;
+    }
+
+    if (steps == 0) {
+        return 0;
+    }
+
+    lora::ChannelPlan* plan = dot->getChannelPlan();
+    uint8_t bandwidth = plan->GetDatarate(dr).Bandwidth;
+    int16_t target = (int16_t)dr + steps;
+
+    // Stay within the plan and on the same bandwidth so the margin model holds
+    if (target < dot->getMinDatarate()) {
+        target = dot->getMinDatarate();
+    }
+    if (target > dot->getMaxDatarate()) {
+        target = dot->getMaxDatarate();
+    }
+    while (target != dr && plan->GetDatarate(target).Bandwidth != bandwidth) {
+        target += (target > dr) ? -1 : 1;
+    }
+
+    if (target == dr) {
+        return 0;
+    }
+
+    if (dot->getAdr()) {
+        logInfo("ADR estimate: margin %d dB, DR%u would suit better than DR%u", m, target, dr);
+    } else if (dot->setTxDataRate(target) == mDot::MDOT_OK) {
+        logInfo("ADR estimate: margin %d dB, datarate DR%u -> DR%u", m, dr, target);
+    }
+
+    return target - dr;
+}
@@ -0,0 +1,84 @@
+#ifndef __ADR_ESTIMATOR_H__
+#define __ADR_ESTIMATOR_H__
+
+#include "mbed.h"
+#include <cstdint>
+
+// Set to 1 to step the uplink datarate on the device while network ADR is off
+#ifndef ADR_ESTIMATOR_ENABLED
+#define ADR_ESTIMATOR_ENABLED               (0)
+#endif
+
+// Link margin in dB kept in reserve for fading
+#ifndef ADR_ESTIMATOR_INSTALL_MARGIN
+#define ADR_ESTIMATOR_INSTALL_MARGIN        (10)
+#endif
+
+// Link margin in dB gained or lost by one datarate step
+#ifndef ADR_ESTIMATOR_STEP_DB
+#define ADR_ESTIMATOR_STEP_DB               (3)
+#endif
+
+// Consecutive estimates with a spare step of margin before moving to a faster datarate
+#ifndef ADR_ESTIMATOR_UP_COUNT
+#define ADR_ESTIMATOR_UP_COUNT              (4)
+#endif
+
+// Uplinks a link check margin is trusted for before falling back to downlink SNR
+#ifndef ADR_ESTIMATOR_LINK_CHECK_AGE
+#define ADR_ESTIMATOR_LINK_CHECK_AGE        (16)
+#endif
+
+/**
+ * Device side estimate of uplink margin used to choose the datarate.
+ *
+ * The margin comes from the demodulation margin of the last LinkCheckAns
+ * when recent, otherwise from the rolling downlink SNR against the SNR the
+ * current spreading factor needs.  Margin falling below the reserve drops
+ * the datarate right away, spare margin must be seen ADR_ESTIMATOR_UP_COUNT
+ * times in a row before the datarate is raised one step.
+ *
+ * With network ADR on the server owns the datarate, the estimate is only
+ * logged.
+ */
+class AdrEstimator {
+public:
+    AdrEstimator();
+
+    /**
+     * Forget margins, call after joining.
+     */
+    void reset();
+
+    /**
+     * Record the margin reported in a LinkCheckAns.
+     *
+     * @param margin_db     Demodulation margin of the uplink at the gateway
+     * @param gateways      Number of gateways that received the uplink
+     */
+    void linkCheck(uint8_t margin_db, uint8_t gateways);
+
+    /**
+     * Estimated margin in dB above the reserve at the current datarate, INT16_MIN if unknown.
+     */
+    int16_t margin();
+
+    /**
+     * Evaluate the margin before an uplink and step the datarate if needed.
+     *
+     * @return datarate steps taken or proposed, negative for slower
+     */
+    int8_t update();
+
+private:
+    static int16_t requiredSnr(uint8_t sf);
+
+    int16_t _linkMargin;        // dB above the demodulation floor from the last link check
+    uint8_t _linkDatarate;      // datarate the link check was done at
+    uint8_t _linkAge;           // uplinks since the last link check
+    uint8_t _upCount;
+};
+
+extern AdrEstimator adr_estimator;
+
+#endif
@@ -0,0 +1,137 @@
+#include "AppEventRing.h"
+
+AppEventRing app_event_ring;
+
+
+AppEventRing::AppEventRing()
+    : _head(0),
+      _count(0),
+      _posted(false),
+      _overflows(0),
+      _merged(0),
+      _postFailures(0)
+{
+    for (uint8_t i = 0; i < APP_EVENT_MAX_SUBSCRIBERS; i++) {
+        _subscribers[i].mask = 0;
+    }
+}
+
+void AppEventRing::push(lora::app::EventNotification en) {
+    bool post = false;
+
+#if APP_PROFILER_ENABLED
+    // Called from the app layer thread
+    app_profiler.sampleAppThread();
+#endif
+
+    core_util_critical_section_enter();
+
+    AppEvent* entry = NULL;
+
+    if (_count > 0) {
+        // Merge with the newest entry to keep order, or any pending entry when full
+        AppEvent* tail = &_ring[(_head + _count - 1) % APP_EVENT_RING_SIZE];
+        if (tail->code == en.code) {
+            entry = tail;
+        } else if (_count == APP_EVENT_RING_SIZE) {
+            for (uint8_t i = 0; i < _count; i++) {
+                AppEvent* e = &_ring[(_head + i) % APP_EVENT_RING_SIZE];
+                if (e->code == en.code) {
+                    entry = e;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (entry != NULL) {
+        if (entry->count < UINT16_MAX) {
+            entry->count++;
+        }
+        entry->last = en.at;
+        _merged++;
+    } else if (_count < APP_EVENT_RING_SIZE) {
+        entry = &_ring[(_head + _count) % APP_EVENT_RING_SIZE];
+        entry->code = en.code;
+        entry->count = 1;
+        entry->first = en.at;
+        entry->last = en.at;
+#if APP_PROFILER_ENABLED
+        _queued[(_head + _count) % APP_EVENT_RING_SIZE] = AppProfiler::now();
+#endif
+        _count++;
+    } else {
+        _overflows++;
+    }
+
+    if (!_posted) {
+        _posted = true;
+        post = true;
+    }
+
+    core_util_critical_section_exit();
+
+    if (post && mbed_event_queue()->call(callback(this, &AppEventRing::dispatch)) == 0) {
+        // Event pool is full, let the next notification post again
+        core_util_critical_section_enter();
+        _posted = false;
+        _postFailures++;
+        core_util_critical_section_exit();
+    }
+}
+
+void AppEventRing::dispatch() {
+    while (true) {
+        AppEvent ev;
+
+        core_util_critical_section_enter();
+        if (_count == 0) {
+            _posted = false;
+            core_util_critical_section_exit();
+            break;
+        }
+        ev = _ring[_head];
+#if APP_PROFILER_ENABLED
+        uint32_t queued = _queued[_head];
+#endif
+        _head = (_head + 1) % APP_EVENT_RING_SIZE;
+        _count--;
+        core_util_critical_section_exit();
+
+#if APP_PROFILER_ENABLED
+        app_profiler.queueWait(AppProfiler::now() - queued);
+#endif
+
+        for (uint8_t i = 0; i < APP_EVENT_MAX_SUBSCRIBERS; i++) {
+            if (_subscribers[i].func && (_subscribers[i].mask & APP_EVENT_MASK(ev.code))) {
+                _subscribers[i].func(ev);
+            }
+        }
+
+#if APP_PROFILER_ENABLED
+        // Subscribers run on the shared event queue, size events.shared-stacksize from this
+        app_profiler.sampleQueueThread();
+#endif
+    }
+}
+
+bool AppEventRing::subscribe(Callback<void(const AppEvent&)> func, uint32_t mask) {
+    for (uint8_t i = 0; i < APP_EVENT_MAX_SUBSCRIBERS; i++) {
+        if (!_subscribers[i].func) {
+            _subscribers[i].func = func;
+            _subscribers[i].mask = mask;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void AppEventRing::unsubscribe(Callback<void(const AppEvent&)> func) {
+    for (uint8_t i = 0; i < APP_EVENT_MAX_SUBSCRIBERS; i++) {
+        if (_subscribers[i].func == func) {
+            _subscribers[i].func = nullptr;
+            _subscribers[i].mask = 0;
+        }
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef __APP_EVENT_RING_H__
+#define __APP_EVENT_RING_H__
+
+#include "mbed.h"
+#include "LoraAppEvent.h"
+#include "AppProfiler.h"
+#include <cstdint>
+#include <ctime>
+
+// Number of distinct pending notifications held between dispatches
+#ifndef APP_EVENT_RING_SIZE
+#define APP_EVENT_RING_SIZE                 (8)
+#endif
+
+// Maximum number of callbacks that can subscribe to notifications
+#ifndef APP_EVENT_MAX_SUBSCRIBERS
+#define APP_EVENT_MAX_SUBSCRIBERS           (4)
+#endif
+
+#define APP_EVENT_MASK(code)                (1UL << (code))
+#define APP_EVENT_MASK_ALL                  (0xFFFFFFFFUL)
+
+/**
+ * Notification delivered to subscribers, repeats of the same code are merged.
+ */
+struct AppEvent {
+    lora::app::EventCode code;
+    uint16_t count;     // number of notifications merged into this entry
+    time_t first;       // time of the first notification
+    time_t last;        // time of the most recent notification
+};
+
+/**
+ * Decouples LoRa application layer notifications from the callbacks that handle them.
+ *
+ * The application layer thread only records the notification in a fixed ring,
+ * merging repeated codes, and handling is deferred to the shared event queue.
+ * A slow subscriber no longer holds up the application layer during fragment
+ * bursts.  When the ring is full and the code cannot be merged the notification
+ * is dropped and counted.
+ */
+class AppEventRing {
+public:
+    AppEventRing();
+
+    /**
+     * Record a notification, attach to the application layer with lora::app::attach.
+     */
+    void push(lora::app::EventNotification en);
+
+    /**
+     * Deliver pending notifications to subscribers.
+     */
+    void dispatch();
+
+    /**
+     * Add a callback for the events selected by mask.
+     *
+     * @param func      Function to call
+     * @param mask      Bitwise OR of APP_EVENT_MASK for each event code
+     * @return true if added, false if all subscriber slots are in use
+     */
+    bool subscribe(Callback<void(const AppEvent&)> func, uint32_t mask = APP_EVENT_MASK_ALL);
+
+    /**
+     * Remove a callback previously added with subscribe.
+     */
+    void unsubscribe(Callback<void(const AppEvent&)> func);
+
+    /**
+     * Number of notifications dropped because the ring was full.
+     */
+    uint32_t overflows() const { return _overflows; }
+
+    /**
+     * Number of notifications merged into an existing entry.
+     */
+    uint32_t merged() const { return _merged; }
+
+    /**
+     * Number of times dispatch could not be posted to the shared event queue.
+     */
+    uint32_t postFailures() const { return _postFailures; }
+
+private:
+    struct Subscriber {
+        Callback<void(const AppEvent&)> func;
+        uint32_t mask;
+    };
+
+    AppEvent _ring[APP_EVENT_RING_SIZE];
+#if APP_PROFILER_ENABLED
+    uint32_t _queued[APP_EVENT_RING_SIZE];   // AppProfiler::now() when each entry was added
+#endif
+    uint8_t _head;
+    uint8_t _count;
+    bool _posted;
+
+    Subscriber _subscribers[APP_EVENT_MAX_SUBSCRIBERS];
+
+    volatile uint32_t _overflows;
+    volatile uint32_t _merged;
+    volatile uint32_t _postFailures;
+};
+
+extern AppEventRing app_event_ring;
+
+#endif
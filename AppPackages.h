@@ -0,0 +1,11 @@
+#ifndef __APP_PACKAGES_H__
+#define __APP_PACKAGES_H__
+
+#include "PackageRegistry.h"
+
+// Application layer packages handled by the firmware, add package types to the list
+typedef PackageRegistry<> AppPackages;
+
+extern AppPackages app_packages;
+
+#endif
@@ -0,0 +1,252 @@
+#include "AppProfiler.h"
+
+#if APP_PROFILER_ENABLED
+
+#include "LoraAppLayer.h"
+#include "MTSLog.h"
+#include "tinycbor.h"
+#include <cstring>
+
+AppProfiler app_profiler;
+
+
+void LatencyHistogram::reset() {
+    memset(bins, 0, sizeof(bins));
+    count = 0;
+    max = 0;
+}
+
+void LatencyHistogram::add(uint32_t us) {
+    uint8_t bin = 0;
+
+    while (us >> bin && bin < APP_PROFILER_BINS - 1) {
+        bin++;
+    }
+
+    bins[bin]++;
+    count++;
+    if (us > max) {
+        max = us;
+    }
+}
+
+
+AppProfiler::AppProfiler() {
+    reset();
+}
+
+void AppProfiler::reset() {
+    core_util_critical_section_enter();
+    _packageCount = 0;
+    _queueWait.reset();
+    _appStackSize = 0;
+    _appStackUsedMax = 0;
+    _queueStackSize = 0;
+    _queueStackUsedMax = 0;
+    core_util_critical_section_exit();
+}
+
+uint32_t AppProfiler::now() {
+    // Low power ticker keeps counting while the MCU is stopped in dot->sleep
+    return (uint32_t)ticker_read_us(get_lp_ticker_data());
+}
+
+uint32_t AppProfiler::stackUsed(osThreadId_t id) {
+    // Stack space is the lowest free space seen when stack watermarking is enabled
+    return osThreadGetStackSize(id) - osThreadGetStackSpace(id);
+}
+
+uint32_t AppProfiler::heapUsed() {
+#if MBED_HEAP_STATS_ENABLED
+    mbed_stats_heap_t stats;
+    mbed_stats_heap_get(&stats);
+    return stats.current_size;
+#else
+    return 0;
+#endif
+}
+
+AppProfiler::Sample AppProfiler::begin() {
+    Sample sample;
+    sample.heap = heapUsed();
+    sample.start = now();
+    return sample;
+}
+
+void AppProfiler::end(uint8_t port, const Sample& sample) {
+    uint32_t elapsed = now() - sample.start;
+    int32_t heap_delta = (int32_t)(heapUsed() - sample.heap);
+    uint32_t stack_used = stackUsed(osThreadGetId());
+
+    core_util_critical_section_enter();
+
+    PackageProfile* profile = NULL;
+    for (uint8_t i = 0; i < _packageCount; i++) {
+        if (_packages[i].port == port) {
+            profile = &_packages[i];
+            break;
+        }
+    }
+
+    if (profile == NULL && _packageCount < APP_PROFILER_MAX_PACKAGES) {
+        profile = &_packages[_packageCount++];
+        profile->port = port;
+        profile->latency.reset();
+        profile->heapDeltaMax = 0;
+        profile->stackUsedMax = 0;
+    }
+
+    if (profile != NULL) {
+        profile->latency.add(elapsed);
+        if (heap_delta > profile->heapDeltaMax) {
+            profile->heapDeltaMax = heap_delta;
+        }
+        if (stack_used > profile->stackUsedMax) {
+            profile->stackUsedMax = stack_used;
+        }
+    }
+
+    core_util_critical_section_exit();
+}
+
+void AppProfiler::queueWait(uint32_t us) {
+    core_util_critical_section_enter();
+    _queueWait.add(us);
+    core_util_critical_section_exit();
+}
+
+void AppProfiler::sampleAppThread() {
+    osThreadId_t id = osThreadGetId();
+    uint32_t used = stackUsed(id);
+
+    _appStackSize = osThreadGetStackSize(id);
+    if (used > _appStackUsedMax) {
+        _appStackUsedMax = used;
+    }
+}
+
+void AppProfiler::sampleQueueThread() {
+    osThreadId_t id = osThreadGetId();
+    uint32_t used = stackUsed(id);
+
+    _queueStackSize = osThreadGetStackSize(id);
+    if (used > _queueStackUsedMax) {
+        _queueStackUsedMax = used;
+    }
+}
+
+const PackageProfile* AppProfiler::package(uint8_t port) const {
+    for (uint8_t i = 0; i < _packageCount; i++) {
+        if (_packages[i].port == port) {
+            return &_packages[i];
+        }
+    }
+    return NULL;
+}
+
+static CborError encode_histogram(CborEncoder* encoder, const LatencyHistogram& hist) {
+    CborEncoder array;
+    uint8_t used = APP_PROFILER_BINS;
+    CborError err;
+
+    // Trailing empty bins are implied
+    while (used > 0 && hist.bins[used - 1] == 0) {
+        used--;
+    }
+
+    err = cbor_encoder_create_array(encoder, &array, used);
+    for (uint8_t i = 0; i < used && err == CborNoError; i++) {
+        err = cbor_encode_uint(&array, hist.bins[i]);
+    }
+    if (err == CborNoError) {
+        err = cbor_encoder_close_container(encoder, &array);
+    }
+    return err;
+}
+
+size_t AppProfiler::encode(uint8_t* buffer, size_t size) const {
+    CborEncoder encoder;
+    CborEncoder map;
+    CborEncoder packages;
+    CborError err;
+
+    cbor_encoder_init(&encoder, buffer, size, 0);
+
+    // { "stk": [size, used], "qstk": [size, used], "wait": [bins], "max": us, "pkg": [{ "p", "lat", "max", "heap", "stk" }] }
+    err = cbor_encoder_create_map(&encoder, &map, 5);
+    err = err ? err : cbor_encode_text_stringz(&map, "stk");
+    {
+        CborEncoder stack;
+        err = err ? err : cbor_encoder_create_array(&map, &stack, 2);
+        err = err ? err : cbor_encode_uint(&stack, _appStackSize);
+        err = err ? err : cbor_encode_uint(&stack, _appStackUsedMax);
+        err = err ? err : cbor_encoder_close_container(&map, &stack);
+    }
+    err = err ? err : cbor_encode_text_stringz(&map, "qstk");
+    {
+        CborEncoder stack;
+        err = err ? err : cbor_encoder_create_array(&map, &stack, 2);
+        err = err ? err : cbor_encode_uint(&stack, _queueStackSize);
+        err = err ? err : cbor_encode_uint(&stack, _queueStackUsedMax);
+        err = err ? err : cbor_encoder_close_container(&map, &stack);
+    }
+    err = err ? err : cbor_encode_text_stringz(&map, "wait");
+    err = err ? err : encode_histogram(&map, _queueWait);
+    err = err ? err : cbor_encode_text_stringz(&map, "max");
+    err = err ? err : cbor_encode_uint(&map, _queueWait.max);
+    err = err ? err : cbor_encode_text_stringz(&map, "pkg");
+    err = err ? err : cbor_encoder_create_array(&map, &packages, _packageCount);
+
+    for (uint8_t i = 0; i < _packageCount && err == CborNoError; i++) {
+        const PackageProfile& p = _packages[i];
+        CborEncoder entry;
+
+        err = cbor_encoder_create_map(&packages, &entry, 5);
+        err = err ? err : cbor_encode_text_stringz(&entry, "p");
+        err = err ? err : cbor_encode_uint(&entry, p.port);
+        err = err ? err : cbor_encode_text_stringz(&entry, "lat");
+        err = err ? err : encode_histogram(&entry, p.latency);
+        err = err ? err : cbor_encode_text_stringz(&entry, "max");
+        err = err ? err : cbor_encode_uint(&entry, p.latency.max);
+        err = err ? err : cbor_encode_text_stringz(&entry, "heap");
+        err = err ? err : cbor_encode_int(&entry, p.heapDeltaMax);
+        err = err ? err : cbor_encode_text_stringz(&entry, "stk");
+        err = err ? err : cbor_encode_uint(&entry, p.stackUsedMax);
+        err = err ? err : cbor_encoder_close_container(&packages, &entry);
+    }
+
+    err = err ? err : cbor_encoder_close_container(&map, &packages);
+    err = err ? err : cbor_encoder_close_container(&encoder, &map);
+
+    if (err != CborNoError) {
+        return 0;
+    }
+
+    return cbor_encoder_get_buffer_size(&encoder, buffer);
+}
+
+int32_t AppProfiler::send(uint8_t port) {
+    static uint8_t report[APP_PROFILER_REPORT_SIZE];
+
+    size_t size = encode(report, sizeof(report));
+    if (size == 0) {
+        logError("Profile report exceeds %d bytes", APP_PROFILER_REPORT_SIZE);
+        return lora::app::ERR_TX_OVERFLOW;
+    }
+
+    return lora::app::packetTx(report, port, size);
+}
+
+void AppProfiler::log() const {
+    logInfo("App thread stack %lu/%lu bytes, event wait max %lu us (%lu events)",
+            _appStackUsedMax, _appStackSize, _queueWait.max, _queueWait.count);
+    logInfo("Event queue thread stack %lu/%lu bytes", _queueStackUsedMax, _queueStackSize);
+
+    for (uint8_t i = 0; i < _packageCount; i++) {
+        const PackageProfile& p = _packages[i];
+        logInfo("Package port %u: %lu msgs, max %lu us, stack %lu bytes, heap +%ld bytes",
+                p.port, p.latency.count, p.latency.max, p.stackUsedMax, p.heapDeltaMax);
+    }
+}
+
+#endif
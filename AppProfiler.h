@@ -0,0 +1,155 @@
+#ifndef __APP_PROFILER_H__
+#define __APP_PROFILER_H__
+
+#include "mbed.h"
+#include <cstddef>
+#include <cstdint>
+
+// Set to 1 in a profiling build, also needs the mbed stack and heap stats, see README.md
+#ifndef APP_PROFILER_ENABLED
+#define APP_PROFILER_ENABLED                (0)
+#endif
+
+// Number of packages that can be profiled
+#ifndef APP_PROFILER_MAX_PACKAGES
+#define APP_PROFILER_MAX_PACKAGES           (4)
+#endif
+
+// Number of latency histogram bins, bin n counts durations from 2^(n-1) to 2^n microseconds
+#ifndef APP_PROFILER_BINS
+#define APP_PROFILER_BINS                   (16)
+#endif
+
+// Port profile reports are sent on
+#ifndef APP_PROFILER_PORT
+#define APP_PROFILER_PORT                   (199)
+#endif
+
+// Bytes reserved for encoding a profile report
+#ifndef APP_PROFILER_REPORT_SIZE
+#define APP_PROFILER_REPORT_SIZE            (222)
+#endif
+
+/**
+ * Log2 histogram of durations in microseconds.
+ */
+struct LatencyHistogram {
+    uint32_t bins[APP_PROFILER_BINS];
+    uint32_t count;
+    uint32_t max;
+
+    void reset();
+    void add(uint32_t us);
+};
+
+/**
+ * Cost of handling messages for one package.
+ */
+struct PackageProfile {
+    uint8_t port;
+    LatencyHistogram latency;
+    int32_t heapDeltaMax;       // largest heap growth across one message in bytes
+    uint32_t stackUsedMax;      // stack high-water of the handling thread in bytes
+};
+
+/**
+ * Records where application layer time and memory go so stack and buffer
+ * sizes can be set from measurements.
+ *
+ * Covers messages handled by the compile time package registry, the wait
+ * between an application layer notification and its handling, and the stack
+ * high-water of the application layer thread, sampled whenever it delivers a
+ * notification, and of the shared event queue thread that handles it.  Stack figures need MBED_STACK_STATS_ENABLED and heap figures
+ * need MBED_HEAP_STATS_ENABLED, otherwise they read zero.
+ *
+ * Only built when APP_PROFILER_ENABLED is set.
+ */
+class AppProfiler {
+public:
+    struct Sample {
+        uint32_t start;
+        uint32_t heap;
+    };
+
+    AppProfiler();
+
+    void reset();
+
+    /**
+     * Microseconds from the low power ticker, in steps of about 31 us.
+     */
+    static uint32_t now();
+
+    /**
+     * Call before handling a message.
+     */
+    Sample begin();
+
+    /**
+     * Call after handling a message.
+     *
+     * @param port      Port of the package that handled the message
+     * @param sample    Value returned by begin
+     */
+    void end(uint8_t port, const Sample& sample);
+
+    /**
+     * Record time a notification waited in the queue.
+     */
+    void queueWait(uint32_t us);
+
+    /**
+     * Record the stack high-water of the calling thread as the application layer thread.
+     */
+    void sampleAppThread();
+
+    /**
+     * Record the stack high-water of the calling thread as the shared event queue thread.
+     */
+    void sampleQueueThread();
+
+    /**
+     * Profile for the package on the port, NULL if no messages were handled.
+     */
+    const PackageProfile* package(uint8_t port) const;
+
+    const LatencyHistogram& queueWait() const { return _queueWait; }
+    uint32_t appStackSize() const { return _appStackSize; }
+    uint32_t appStackUsedMax() const { return _appStackUsedMax; }
+    uint32_t queueStackSize() const { return _queueStackSize; }
+    uint32_t queueStackUsedMax() const { return _queueStackUsedMax; }
+
+    /**
+     * Encode the profile as CBOR.
+     *
+     * @return Encoded size in bytes, 0 if the buffer is too small
+     */
+    size_t encode(uint8_t* buffer, size_t size) const;
+
+    /**
+     * Encode the profile and queue it for transmission with lora::app::packetTx.
+     */
+    int32_t send(uint8_t port = APP_PROFILER_PORT);
+
+    /**
+     * Print the profile to the debug log.
+     */
+    void log() const;
+
+private:
+    static uint32_t stackUsed(osThreadId_t id);
+    static uint32_t heapUsed();
+
+    PackageProfile _packages[APP_PROFILER_MAX_PACKAGES];
+    uint8_t _packageCount;
+
+    LatencyHistogram _queueWait;
+    uint32_t _appStackSize;
+    uint32_t _appStackUsedMax;
+    uint32_t _queueStackSize;
+    uint32_t _queueStackUsedMax;
+};
+
+extern AppProfiler app_profiler;
+
+#endif
@@ -0,0 +1,212 @@
+#include "ClockDiscipline.h"
+#include "LoraAppLayer.h"
+#include "MTSLog.h"
+#include <cmath>
+#include <algorithm>
+
+ClockDiscipline clock_discipline;
+
+
+ClockDiscipline::ClockDiscipline(uint32_t max_error_ms)
+    : _maxError(max_error_ms)
+{
+    clear();
+}
+
+void ClockDiscipline::reset() {
+    ScopedLock<Mutex> lock(_mutex);
+    clear();
+}
+
+void ClockDiscipline::clear() {
+    _count = 0;
+    _next = 0;
+    _resolution = 1000;
+    _slope = 0.0;
+    _slopeError = 0.0;
+}
+
+void ClockDiscipline::sample(time_t rtc_s, int64_t offset_ms, uint16_t resolution_ms) {
+    ScopedLock<Mutex> lock(_mutex);
+
+    if (_count > 0) {
+        const Sample& last = _samples[(_next + CLOCK_DISCIPLINE_SAMPLES - 1) % CLOCK_DISCIPLINE_SAMPLES];
+
+        if (rtc_s < last.rtc) {
+            // RTC was moved backwards, previous corrections no longer apply
+            clear();
+        } else if (rtc_s == last.rtc) {
+            // Same correction reported twice, keep the latest
+            _next = (_next + CLOCK_DISCIPLINE_SAMPLES - 1) % CLOCK_DISCIPLINE_SAMPLES;
+            _count--;
+        }
+    }
+
+    _samples[_next].rtc = rtc_s;
+    _samples[_next].offset = offset_ms;
+    _samples[_next].resolution = resolution_ms;
+    _next = (_next + 1) % CLOCK_DISCIPLINE_SAMPLES;
+    if (_count < CLOCK_DISCIPLINE_SAMPLES) {
+        _count++;
+    }
+
+    fit();
+}
+
+void ClockDiscipline::fit() {
+    _slope = 0.0;
+    _slopeError = 0.0;
+
+    uint8_t first = (_next + CLOCK_DISCIPLINE_SAMPLES - _count) % CLOCK_DISCIPLINE_SAMPLES;
+    time_t ref = _samples[first].rtc;
+    double mean_x = 0.0;
+    double mean_y = 0.0;
+
+    // Use the coarsest resolution in the window
+    _resolution = 0;
+
+    for (uint8_t i = 0; i < _count; i++) {
+        const Sample& s = _samples[(first + i) % CLOCK_DISCIPLINE_SAMPLES];
+        _resolution = std::max(_resolution, s.resolution);
+        mean_x += (double)(s.rtc - ref);
+        mean_y += (double)s.offset;
+    }
+    if (_count < 2) {
+        return;
+    }
+
+    mean_x /= _count;
+    mean_y /= _count;
+
+    double sxx = 0.0;
+    double sxy = 0.0;
+
+    for (uint8_t i = 0; i < _count; i++) {
+        const Sample& s = _samples[(first + i) % CLOCK_DISCIPLINE_SAMPLES];
+        double dx = (double)(s.rtc - ref) - mean_x;
+        sxx += dx * dx;
+        sxy += dx * ((double)s.offset - mean_y);
+    }
+
+    if (sxx <= 0.0) {
+        return;
+    }
+
+    _slope = sxy / sxx;
+
+    // Each offset is only known to within the resolution of the server time
+    double baseline = (double)(_samples[(_next + CLOCK_DISCIPLINE_SAMPLES - 1) % CLOCK_DISCIPLINE_SAMPLES].rtc - ref);
+    _slopeError = _resolution / baseline;
+}
+
+bool ClockDiscipline::hasEstimate() const {
+    ScopedLock<Mutex> lock(_mutex);
+
+    if (_count < 2) {
+        return false;
+    }
+
+    uint8_t first = (_next + CLOCK_DISCIPLINE_SAMPLES - _count) % CLOCK_DISCIPLINE_SAMPLES;
+    uint8_t last = (_next + CLOCK_DISCIPLINE_SAMPLES - 1) % CLOCK_DISCIPLINE_SAMPLES;
+
+    return (_samples[last].rtc - _samples[first].rtc) >= CLOCK_DISCIPLINE_MIN_BASELINE;
+}
+
+int32_t ClockDiscipline::driftPpb() const {
+    ScopedLock<Mutex> lock(_mutex);
+
+    // ms per second to parts per billion
+    return (int32_t)(_slope * 1e6);
+}
+
+int64_t ClockDiscipline::predictOffset(time_t rtc_s) const {
+    ScopedLock<Mutex> lock(_mutex);
+
+    if (_count == 0) {
+        return 0;
+    }
+
+    const Sample& last = _samples[(_next + CLOCK_DISCIPLINE_SAMPLES - 1) % CLOCK_DISCIPLINE_SAMPLES];
+
+    if (!hasEstimate()) {
+        return last.offset;
+    }
+
+    return last.offset + (int64_t)llround(_slope * (double)(rtc_s - last.rtc));
+}
+
+uint32_t ClockDiscipline::predictError(time_t rtc_s) const {
+    ScopedLock<Mutex> lock(_mutex);
+
+    if (_count == 0) {
+        return UINT32_MAX;
+    }
+
+    const Sample& last = _samples[(_next + CLOCK_DISCIPLINE_SAMPLES - 1) % CLOCK_DISCIPLINE_SAMPLES];
+    double elapsed = (rtc_s > last.rtc) ? (double)(rtc_s - last.rtc) : 0.0;
+    double error = _resolution / 2.0 + (fabs(_slope) + _slopeError) * elapsed;
+
+    return (error < (double)UINT32_MAX) ? (uint32_t)error : UINT32_MAX;
+}
+
+uint8_t ClockDiscipline::resyncPeriod() const {
+    ScopedLock<Mutex> lock(_mutex);
+
+    if (!hasEstimate()) {
+        return LORA_APP_LAYER_CLOCK_SYNC_PERIOD;
+    }
+
+    double budget = (double)_maxError - _resolution / 2.0;
+    double drift = fabs(_slope) + _slopeError;
+
+    if (budget <= 0.0) {
+        return 1;
+    }
+
+    // Periodicity = 128 * 2^period seconds
+    for (uint8_t period = 15; period > 1; period--) {
+        if (drift * (double)(128UL << period) <= budget) {
+            return period;
+        }
+    }
+
+    return 1;
+}
+
+bool ClockDiscipline::resyncNeeded(time_t rtc_s) const {
+    ScopedLock<Mutex> lock(_mutex);
+
+    return hasEstimate() && predictError(rtc_s) > _maxError;
+}
+
+
+void clock_discipline_update(time_t rtc_s, int64_t offset_ms, uint16_t resolution_ms) {
+    static uint8_t applied_period = LORA_APP_LAYER_CLOCK_SYNC_PERIOD;
+
+    clock_discipline.sample(rtc_s, offset_ms, resolution_ms);
+
+    uint8_t period = clock_discipline.resyncPeriod();
+
+    if (period != applied_period) {
+        logInfo("RTC drift %d ppb, clock sync period %u -> %u", clock_discipline.driftPpb(), applied_period, period);
+        lora::app::setClockResyncPeriod(period);
+        applied_period = period;
+    }
+}
+
+void clock_discipline_poll(time_t rtc_s) {
+    static time_t requested = 0;
+
+    if (!lora::app::getClockSynced() || !clock_discipline.resyncNeeded(rtc_s)) {
+        return;
+    }
+
+    // Give the outstanding request time to complete before asking again
+    if (requested != 0 && rtc_s - requested < LORA_APP_LAYER_CLOCK_RESYNC_ATTEMPTS * LORA_APP_LAYER_CLOCK_RESYNC_DELAY) {
+        return;
+    }
+
+    logInfo("Predicted clock error %lu ms exceeds %lu ms, requesting sync", clock_discipline.predictError(rtc_s), clock_discipline.getMaxError());
+    lora::app::resyncClock();
+    requested = rtc_s;
+}
@@ -0,0 +1,120 @@
+#ifndef __CLOCK_DISCIPLINE_H__
+#define __CLOCK_DISCIPLINE_H__
+
+#include "mbed.h"
+#include <cstdint>
+#include <ctime>
+
+// Maximum error in milliseconds allowed between the synced clock and server time,
+// multicast session starts for class B/C are scheduled using the synced clock
+#ifndef CLOCK_DISCIPLINE_MAX_ERROR_MS
+#define CLOCK_DISCIPLINE_MAX_ERROR_MS       (1000)
+#endif
+
+// Number of clock corrections kept to estimate RTC drift
+#ifndef CLOCK_DISCIPLINE_SAMPLES
+#define CLOCK_DISCIPLINE_SAMPLES            (8)
+#endif
+
+// Minimum span in seconds between first and last correction before drift is trusted
+#ifndef CLOCK_DISCIPLINE_MIN_BASELINE
+#define CLOCK_DISCIPLINE_MIN_BASELINE       (3600)
+#endif
+
+/**
+ * Estimates RTC drift from the sequence of clock corrections received from the
+ * server and chooses the clock sync periodicity so the predicted error between
+ * syncs stays inside CLOCK_DISCIPLINE_MAX_ERROR_MS.
+ *
+ * Periodicity follows the Clock Synchronization package: 128 * 2^period seconds.
+ *
+ * Corrections arrive on the MAC thread while the main loop and the synced
+ * clock read the estimate, every method takes the same lock.
+ */
+class ClockDiscipline {
+public:
+    ClockDiscipline(uint32_t max_error_ms = CLOCK_DISCIPLINE_MAX_ERROR_MS);
+
+    /**
+     * Record the offset between server time and the RTC after a correction.
+     *
+     * @param rtc_s         RTC time the correction was applied
+     * @param offset_ms     Server time minus RTC time in milliseconds
+     * @param resolution_ms Resolution of the server time used for the correction
+     */
+    void sample(time_t rtc_s, int64_t offset_ms, uint16_t resolution_ms = 1000);
+
+    /**
+     * Forget all corrections, call when the RTC is reset or set directly.
+     */
+    void reset();
+
+    /**
+     * Indicates enough corrections have been seen to estimate drift.
+     */
+    bool hasEstimate() const;
+
+    /**
+     * Estimated RTC drift in parts per billion, positive when the RTC runs slow.
+     */
+    int32_t driftPpb() const;
+
+    /**
+     * Predicted server time minus RTC time in milliseconds at the given RTC time.
+     */
+    int64_t predictOffset(time_t rtc_s) const;
+
+    /**
+     * Worst case error in milliseconds of the last correction at the given RTC time.
+     */
+    uint32_t predictError(time_t rtc_s) const;
+
+    /**
+     * Clock sync periodicity to keep error inside the budget, 1-15.
+     */
+    uint8_t resyncPeriod() const;
+
+    /**
+     * Indicates predicted error has exceeded the budget and a sync should be requested.
+     */
+    bool resyncNeeded(time_t rtc_s) const;
+
+    uint32_t getMaxError() const { return _maxError; }
+    void setMaxError(uint32_t max_error_ms) { _maxError = max_error_ms; }
+
+private:
+    struct Sample {
+        time_t rtc;
+        int64_t offset;
+        uint16_t resolution;
+    };
+
+    void clear();
+    void fit();
+
+    Sample _samples[CLOCK_DISCIPLINE_SAMPLES];
+    uint8_t _count;
+    uint8_t _next;
+
+    uint32_t _maxError;
+    uint16_t _resolution;
+
+    double _slope;          // ms of offset change per second of RTC
+    double _slopeError;     // bound on slope error from sample resolution
+
+    mutable Mutex _mutex;
+};
+
+extern ClockDiscipline clock_discipline;
+
+/**
+ * Record a correction and apply the resulting clock sync periodicity to the LoRa application layer.
+ */
+void clock_discipline_update(time_t rtc_s, int64_t offset_ms, uint16_t resolution_ms = 1000);
+
+/**
+ * Request a clock sync if the predicted error has grown past the budget before the next periodic sync.
+ */
+void clock_discipline_poll(time_t rtc_s);
+
+#endif
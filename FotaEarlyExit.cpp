@@ -0,0 +1,80 @@
+#include "FotaEarlyExit.h"
+#include "LoraAppPackage.h"
+#include "dot_util.h"
+#include <algorithm>
+
+FotaEarlyExit fota_early_exit;
+
+// Fragmented Data Block Transport FragSessionStatusAns command
+static const uint8_t FRAG_SESSION_STATUS_CID = 0x01;
+
+
+FotaEarlyExit::FotaEarlyExit()
+    : _context(NULL),
+      _attempts(0),
+      _done(false)
+{
+}
+
+void FotaEarlyExit::reset() {
+    _context = NULL;
+    _attempts = 0;
+    _done = false;
+}
+
+void FotaEarlyExit::fileReceived() {
+    if (_done) {
+        return;
+    }
+
+    _context = NULL;
+    for (uint8_t i = 0; i < lora::app::FOTA_MAX_FRAG_SESSIONS; i++) {
+        lora::app::FragmentationContext* context = lora::app::fota().getSessionContext(i);
+        if (context != NULL && context->flags.complete) {
+            _context = context;
+            break;
+        }
+    }
+
+    if (_context == NULL) {
+        return;
+    }
+
+    _done = true;
+
+    logInfo("FOTA file complete with %d fragments, closing multicast session", _context->getTotalRcvdFrameCount());
+    lora::app::closeActiveMulticastSession();
+
+    if (!_context->flags.ackReception) {
+        _attempts = 0;
+        sendStatus();
+    }
+}
+
+void FotaEarlyExit::sendStatus() {
+    if (_context == NULL) {
+        return;
+    }
+
+    uint16_t received = std::min(_context->getTotalRcvdFrameCount(), 0x3FFF);
+    uint16_t received_and_index = (_context->index << 14) | received;
+
+    uint8_t payload[5];
+    payload[0] = FRAG_SESSION_STATUS_CID;
+    payload[1] = received_and_index & 0xFF;
+    payload[2] = received_and_index >> 8;
+    payload[3] = std::min(_context->getTotalMissingFrameCount(), 0xFF);
+    payload[4] = _context->flags.matrixMemoryError ? 0x01 : 0x00;
+
+    int32_t ret = lora::app::packetTx(payload, LAP_FPORT_FRAG, sizeof(payload));
+
+    bool busy = (ret == lora::app::ERR_TX_BUSY || ret == lora::app::ERR_TX_OVERFLOW);
+
+    if (busy && ++_attempts < FOTA_EARLY_EXIT_STATUS_ATTEMPTS) {
+        mbed_event_queue()->call_in(std::chrono::milliseconds(FOTA_EARLY_EXIT_STATUS_RETRY_MS), callback(this, &FotaEarlyExit::sendStatus));
+    } else if (ret != lora::app::ERR_OK) {
+        logError("failed to queue FragSessionStatusAns: %d", ret);
+    } else {
+        logInfo("FragSessionStatusAns queued, %u fragments received", received);
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef __FOTA_EARLY_EXIT_H__
+#define __FOTA_EARLY_EXIT_H__
+
+#include "mbed.h"
+#include "FragmentationContext.h"
+#include <cstdint>
+
+// Attempts to queue FragSessionStatusAns while another app layer uplink is pending
+#ifndef FOTA_EARLY_EXIT_STATUS_ATTEMPTS
+#define FOTA_EARLY_EXIT_STATUS_ATTEMPTS     (5)
+#endif
+
+// Milliseconds between attempts to queue FragSessionStatusAns
+#ifndef FOTA_EARLY_EXIT_STATUS_RETRY_MS
+#define FOTA_EARLY_EXIT_STATUS_RETRY_MS     (1000)
+#endif
+
+/**
+ * Stops listening as soon as the FOTA file has been rebuilt instead of
+ * keeping the class C window open until the multicast session ends.
+ *
+ * On EVENT_FOTA_FILE_RECEIVED the active multicast session is closed, which
+ * returns the device to its original class.  FragSessionStatusAns is sent
+ * straight away unless the server asked for an acknowledgment, which the
+ * app layer then sends itself.  Restoring the class is left to the MAC,
+ * which also puts the radio to sleep when the device is back in class A.
+ */
+class FotaEarlyExit {
+public:
+    FotaEarlyExit();
+
+    /**
+     * Close the session after the file was received.
+     */
+    void fileReceived();
+
+    /**
+     * Forget the completed session, call when a new session is created.
+     */
+    void reset();
+
+    /**
+     * Indicates the file was received and the multicast session closed early.
+     */
+    bool done() const { return _done; }
+
+private:
+    void sendStatus();
+
+    lora::app::FragmentationContext* _context;
+    uint8_t _attempts;
+    bool _done;
+};
+
+extern FotaEarlyExit fota_early_exit;
+
+#endif
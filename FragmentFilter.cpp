@@ -0,0 +1,98 @@
+#include "FragmentFilter.h"
+#include "LoraAppLayer.h"
+#include "LoraAppPackage.h"
+#include "Fota.h"
+#include "MTSLog.h"
+#include <cstring>
+
+FragmentFilter fragment_filter;
+
+// Fragmented Data Block Transport DataFragment command
+static const uint8_t DATA_FRAGMENT_CID = 0x08;
+static const uint16_t DATA_FRAGMENT_HEADER_SIZE = 3;
+
+
+FragmentFilter::FragmentFilter()
+    : _duplicates(0),
+      _redundant(0)
+{
+    reset();
+}
+
+void FragmentFilter::reset() {
+    memset(_sessions, 0, sizeof(_sessions));
+}
+
+bool FragmentFilter::parse(uint8_t port, const uint8_t* payload, uint16_t size, uint8_t& index, uint16_t& n) {
+    if (port != LAP_FPORT_FRAG || size <= DATA_FRAGMENT_HEADER_SIZE || payload[0] != DATA_FRAGMENT_CID) {
+        return false;
+    }
+
+    // IndexAndN, 14 bit fragment number counted from 1 and 2 bit session index
+    uint16_t index_and_n = payload[1] | (payload[2] << 8);
+    index = index_and_n >> 14;
+    n = index_and_n & 0x3FFF;
+
+    return n != 0;
+}
+
+lora::app::FragmentationContext* FragmentFilter::session(uint8_t index) {
+    lora::app::FragmentationContext* context = lora::app::fota().getSessionContext(index);
+
+    if (context == NULL) {
+        return NULL;
+    }
+
+    Session& tracked = _sessions[index];
+
+    if (!tracked.valid || context->sessionCnt != tracked.sessionCnt || context->nFrags != tracked.nFrags) {
+        memset(&tracked, 0, sizeof(tracked));
+        tracked.valid = true;
+        tracked.sessionCnt = context->sessionCnt;
+        tracked.nFrags = context->nFrags;
+    }
+
+    return context;
+}
+
+bool FragmentFilter::drop(uint8_t port, const uint8_t* payload, uint16_t size) {
+    uint8_t index;
+    uint16_t n;
+
+    lora::app::FragmentationContext* context = parse(port, payload, size, index, n) ? session(index) : NULL;
+
+    if (context == NULL) {
+        return false;
+    }
+
+    Session& tracked = _sessions[index];
+
+    // Only the decoder knows when it is full rank, a queued fragment may still be discarded
+    if (context->flags.complete) {
+        if (!tracked.complete) {
+            tracked.complete = true;
+            logInfo("Fragment session %u complete, dropping further fragments", index);
+        }
+        _redundant++;
+        return true;
+    }
+
+    if (n <= FRAGMENT_FILTER_MAX_FRAGS && (tracked.received[(n - 1) / 32] & (1UL << ((n - 1) % 32)))) {
+        _duplicates++;
+        logTrace("Fragment %u of session %u already received", n, index);
+        return true;
+    }
+
+    return false;
+}
+
+void FragmentFilter::accepted(uint8_t port, const uint8_t* payload, uint16_t size) {
+    uint8_t index;
+    uint16_t n;
+
+    if (!parse(port, payload, size, index, n) || session(index) == NULL || n > FRAGMENT_FILTER_MAX_FRAGS) {
+        return;
+    }
+
+    _sessions[index].received[(n - 1) / 32] |= 1UL << ((n - 1) % 32);
+}
@@ -0,0 +1,82 @@
+#ifndef __FRAGMENT_FILTER_H__
+#define __FRAGMENT_FILTER_H__
+
+#include "mbed.h"
+#include "FragmentationContext.h"
+#include "Fota.h"
+#include <cstdint>
+
+// Fragments tracked per session, later fragments are passed through unfiltered
+#ifndef FRAGMENT_FILTER_MAX_FRAGS
+#define FRAGMENT_FILTER_MAX_FRAGS           (4096)
+#endif
+
+/**
+ * Drops fragments that cannot help the FOTA session before they reach the
+ * application layer.
+ *
+ * DataFragment messages are checked against a bitmap of fragments already
+ * taken by the application layer for the session.  Repeats are dropped
+ * without being queued, copied or decoded.  Once the decoder reports the
+ * file rebuilt every further fragment is dropped as redundant.  Each of the
+ * four session indexes keeps its own bitmap so interleaved sessions do not
+ * clear each other.
+ */
+class FragmentFilter {
+public:
+    FragmentFilter();
+
+    /**
+     * Forget the received fragments of all sessions.
+     */
+    void reset();
+
+    /**
+     * Check a downlink before passing it to the application layer.
+     *
+     * @param port          Port the downlink was received on
+     * @param payload       Downlink payload
+     * @param size          Size of payload
+     * @return true if the downlink should be dropped
+     */
+    bool drop(uint8_t port, const uint8_t* payload, uint16_t size);
+
+    /**
+     * Record a downlink taken by the application layer.
+     *
+     * @param port          Port the downlink was received on
+     * @param payload       Downlink payload
+     * @param size          Size of payload
+     */
+    void accepted(uint8_t port, const uint8_t* payload, uint16_t size);
+
+    /**
+     * Fragments dropped because they were already received.
+     */
+    uint32_t duplicates() const { return _duplicates; }
+
+    /**
+     * Fragments dropped because the file was already rebuilt.
+     */
+    uint32_t redundant() const { return _redundant; }
+
+private:
+    struct Session {
+        uint32_t received[FRAGMENT_FILTER_MAX_FRAGS / 32];
+        uint16_t nFrags;        // Uncoded fragments in the session
+        uint16_t sessionCnt;
+        bool valid;             // Tracking a session on this index
+        bool complete;          // File rebuilt
+    };
+
+    bool parse(uint8_t port, const uint8_t* payload, uint16_t size, uint8_t& index, uint16_t& n);
+    lora::app::FragmentationContext* session(uint8_t index);
+
+    Session _sessions[lora::app::FOTA_MAX_FRAG_SESSIONS];
+    uint32_t _duplicates;
+    uint32_t _redundant;
+};
+
+extern FragmentFilter fragment_filter;
+
+#endif
@@ -0,0 +1,175 @@
+#include "MulticastScheduler.h"
+#include "SyncedClock.h"
+#include "dot_util.h"
+#include <algorithm>
+#include <cstring>
+
+MulticastScheduler multicast_scheduler;
+
+
+MulticastScheduler::MulticastScheduler()
+    : _count(0),
+      _group(mDot::INVALID_MULTICAST_ID),
+      _groupClassB(false),
+      _start(0),
+      _guardMs(MULTICAST_START_GUARD_MS),
+      _end(0),
+      _prevEnd(0),
+      _overlaps(0)
+{
+    memset(_reported, 0, sizeof(_reported));
+}
+
+bool MulticastScheduler::later(const Session& a, const Session& b) {
+    // Heap keeps the earliest start on top, lower group wins a tie
+    return a.start > b.start || (a.start == b.start && a.group > b.group);
+}
+
+void MulticastScheduler::push(const Session& session) {
+    if (_count >= lora::MAX_MULTICAST_SESSIONS) {
+        return;
+    }
+
+    _heap[_count++] = session;
+    std::push_heap(_heap, _heap + _count, later);
+}
+
+bool MulticastScheduler::pop(Session& session) {
+    if (_count == 0) {
+        return false;
+    }
+
+    std::pop_heap(_heap, _heap + _count, later);
+    session = _heap[--_count];
+    return true;
+}
+
+void MulticastScheduler::load(time_t now) {
+    _count = 0;
+    _end = 0;
+
+    for (uint8_t i = 0; i < lora::MAX_MULTICAST_SESSIONS; i++) {
+        time_t start = dot->getMulticastSessionStartTime(i);
+        time_t end = dot->getMulticastSessionEndTime(i);
+
+        if (start == 0 || end <= now) {
+            continue;
+        }
+
+        if (dot->getMulticastSessionActive(i)) {
+            // Running session holds the radio until it ends
+            _end = std::max(_end, end);
+            continue;
+        }
+
+        Session session = { start, end, i, dot->getMulticastSessionClass(i) == "B" };
+        push(session);
+    }
+
+    // Report overlaps in start order
+    Session sorted[lora::MAX_MULTICAST_SESSIONS];
+    std::copy(_heap, _heap + _count, sorted);
+    std::sort_heap(sorted, sorted + _count, later);
+
+    time_t end = _end;
+    for (int8_t i = _count - 1; i >= 0; i--) {
+        // Sessions are loaded again on every reschedule, count each one once
+        if (sorted[i].start < end && _reported[sorted[i].group] != sorted[i].start) {
+            _reported[sorted[i].group] = sorted[i].start;
+            _overlaps++;
+            logWarning("Multicast group %u class %c starting %lu overlaps an earlier session until %lu",
+                       sorted[i].group, sorted[i].classB ? 'B' : 'C', (uint32_t)sorted[i].start, (uint32_t)end);
+        }
+        end = std::max(end, sorted[i].end);
+    }
+}
+
+void MulticastScheduler::reschedule() {
+    cancel();
+
+    if (dot == NULL || !lora::app::getClockSynced()) {
+        return;
+    }
+
+    load(lora::app::syncedTime());
+    arm();
+}
+
+void MulticastScheduler::arm() {
+    Session session;
+
+    while (pop(session)) {
+        if (session.start < _end) {
+            if (session.end <= _end) {
+                logInfo("Multicast group %u dropped, ends within an earlier session", session.group);
+                continue;
+            }
+
+            // Back-to-back with the earlier session
+            session.start = _end;
+        }
+
+        // Switching early must not cut the end off an earlier session
+        int64_t gap_ms = ((int64_t)session.start - (int64_t)_end) * 1000;
+        _guardMs = (_end == 0 || gap_ms >= MULTICAST_START_GUARD_MS) ? MULTICAST_START_GUARD_MS : std::max<int64_t>(gap_ms, 0);
+
+        _group = session.group;
+        _groupClassB = session.classB;
+        _start = session.start;
+        _prevEnd = _end;
+        _end = session.end;
+
+        int64_t delay = synced_clock.msUntil(_start) - _guardMs;
+
+        if (delay <= 0) {
+            // Already due, start from thread context
+            mbed_event_queue()->call(callback(this, &MulticastScheduler::start));
+            return;
+        }
+
+        logInfo("Multicast group %u class %c starts in %lu ms, %u more queued",
+                _group, _groupClassB ? 'B' : 'C', (uint32_t)(delay + _guardMs), _count);
+        _timeout.attach(callback(this, &MulticastScheduler::expired), std::chrono::milliseconds(delay));
+        return;
+    }
+}
+
+void MulticastScheduler::cancel() {
+    _timeout.detach();
+    _count = 0;
+    _group = mDot::INVALID_MULTICAST_ID;
+    _start = 0;
+}
+
+int64_t MulticastScheduler::msUntilStart() {
+    if (_group == mDot::INVALID_MULTICAST_ID) {
+        return -1;
+    }
+
+    int64_t ms = synced_clock.msUntil(_start) - _guardMs;
+    return (ms > 0) ? ms : 0;
+}
+
+void MulticastScheduler::expired() {
+    // Runs in interrupt context, radio cannot be configured here
+    mbed_event_queue()->call(callback(this, &MulticastScheduler::start));
+}
+
+void MulticastScheduler::start() {
+    if (_group == mDot::INVALID_MULTICAST_ID) {
+        return;
+    }
+
+    uint8_t group = _group;
+    _group = mDot::INVALID_MULTICAST_ID;
+
+    int32_t ret = dot->multicastSessionStart(group);
+    if (ret != mDot::MDOT_OK) {
+        logError("failed to start multicast group %u: %d", group, ret);
+        // Failed session does not hold the radio, an earlier one still running does
+        _end = _prevEnd;
+        arm();
+    } else {
+        logInfo("Multicast group %u started %ld ms before session start", group, (int32_t)synced_clock.msUntil(_start));
+    }
+}
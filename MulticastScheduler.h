@@ -0,0 +1,96 @@
+#ifndef __MULTICAST_SCHEDULER_H__
+#define __MULTICAST_SCHEDULER_H__
+
+#include "mbed.h"
+#include "Lora.h"
+#include <cstdint>
+#include <ctime>
+
+// Milliseconds before the session start time the radio is switched to the multicast session,
+// covers clock error and the time to reconfigure the radio
+#ifndef MULTICAST_START_GUARD_MS
+#define MULTICAST_START_GUARD_MS            (250)
+#endif
+
+/**
+ * Starts multicast sessions at their start time using the millisecond synced
+ * clock, so the radio is listening when the first fragment is sent rather
+ * than up to a second late.
+ *
+ * Sessions of all groups are kept in a min-heap ordered by start time, class
+ * B and class C alike.  A session starting before the previous one ends is
+ * logged and counted once as an overlap, the sessions are set up by the server so
+ * they are not rejected.  An overlapping session is started as the previous
+ * one ends if it runs past it, otherwise it is dropped.  While a session runs
+ * the next one is already armed, so back-to-back sessions follow without a
+ * gap.  The start guard is shortened so an earlier session is not cut short.
+ */
+class MulticastScheduler {
+public:
+    MulticastScheduler();
+
+    /**
+     * Load the sessions of all groups and arm the start timer for the first.
+     * Call after a session is setup, started or closed, or the clock is
+     * synchronized.
+     */
+    void reschedule();
+
+    /**
+     * Cancel the pending start and forget the queued sessions.
+     */
+    void cancel();
+
+    /**
+     * Group ID of the scheduled session or mDot::INVALID_MULTICAST_ID.
+     */
+    uint8_t pendingGroup() const { return _group; }
+
+    /**
+     * Sessions waiting behind the scheduled one.
+     */
+    uint8_t queued() const { return _count; }
+
+    /**
+     * Sessions found overlapping an earlier one since boot.
+     */
+    uint32_t overlaps() const { return _overlaps; }
+
+    /**
+     * Milliseconds until the radio is switched to the scheduled session, negative if none is scheduled.
+     */
+    int64_t msUntilStart();
+
+private:
+    struct Session {
+        time_t start;
+        time_t end;
+        uint8_t group;
+        bool classB;
+    };
+
+    static bool later(const Session& a, const Session& b);
+
+    void load(time_t now);
+    void push(const Session& session);
+    bool pop(Session& session);
+    void arm();
+    void expired();
+    void start();
+
+    LowPowerTimeout _timeout;
+    Session _heap[lora::MAX_MULTICAST_SESSIONS];
+    uint8_t _count;
+    uint8_t _group;
+    bool _groupClassB;
+    time_t _start;
+    int64_t _guardMs;           // Time before _start the session is switched to
+    time_t _end;                // End of the last session taken from the heap
+    time_t _prevEnd;            // _end before the scheduled session was taken
+    time_t _reported[lora::MAX_MULTICAST_SESSIONS];    // Start of the last overlap counted for each group
+    uint32_t _overlaps;
+};
+
+extern MulticastScheduler multicast_scheduler;
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef __PACKAGE_REGISTRY_H__
+#define __PACKAGE_REGISTRY_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include "LoraAppLayer.h"
+#include "AppProfiler.h"
+
+namespace detail {
+
+template <typename... P>
+constexpr bool package_ports_unique() {
+    const uint8_t ports[] = { P::PORT..., 0 };
+    for (size_t i = 0; i < sizeof...(P); i++) {
+        for (size_t j = i + 1; j < sizeof...(P); j++) {
+            if (ports[i] == ports[j]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <typename... P>
+constexpr bool package_ids_unique() {
+    const uint8_t ids[] = { P::ID..., 0 };
+    for (size_t i = 0; i < sizeof...(P); i++) {
+        for (size_t j = i + 1; j < sizeof...(P); j++) {
+            if (ids[i] == ids[j]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <typename... P>
+constexpr bool package_ports_available() {
+    const uint8_t ports[] = { P::PORT..., 0 };
+    for (size_t i = 0; i < sizeof...(P); i++) {
+        // Application ports are 1-223, 200-203 are used by the built in LoRa App packages
+        if (ports[i] == LA_FPORT_MAC || ports[i] >= LA_FPORT_CERTIF ||
+            (ports[i] >= LAP_FPORT_MCAST && ports[i] <= LAP_FPORT_FWMNGT)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Position of P in the list, fails to compile if P is not in the list
+template <typename P, typename... L>
+struct package_index;
+
+template <typename P, typename... L>
+struct package_index<P, P, L...> : std::integral_constant<size_t, 0> {};
+
+template <typename P, typename H, typename... L>
+struct package_index<P, H, L...> : std::integral_constant<size_t, 1 + package_index<P, L...>::value> {};
+
+// Static storage for one package, the app layer lists it and calls it on its own thread
+template <typename P>
+class package_slot final : public lora::app::Package {
+public:
+    package_slot() : lora::app::Package(lora::app::PackageInfo{ P::PORT, P::ID, P::VERSION }) {}
+
+    void handleMessage(lora::app::MessageBuffer& recv, lora::app::MessageBuffer& resp) override {
+#if APP_PROFILER_ENABLED
+        AppProfiler::Sample sample = app_profiler.begin();
+#endif
+        // Qualified call, no virtual dispatch
+        _package.P::handleMessage(recv, resp);
+#if APP_PROFILER_ENABLED
+        app_profiler.end(P::PORT, sample);
+#endif
+    }
+
+    P& package() { return _package; }
+
+private:
+    P _package;
+};
+
+} // namespace detail
+
+/**
+ * Application layer packages fixed at compile time.
+ *
+ * Each package type is default constructible, provides static constexpr
+ * PORT, ID and VERSION members and a handleMessage method, preferably marked
+ * final.  Packages are stored in the registry itself, nothing is allocated
+ * on the heap.
+ *
+ * Call begin after lora::app::init to hand the packages to the app layer.
+ * Messages are then handled on the app layer thread like the built in
+ * packages and the packages are reported by Multi-Package Access.
+ *
+ * Reusing a port, including one of the built in package ports, fails to compile
+ * instead of returning ERR_PORT_REUSE from lora::app::addPackage.
+ *
+ * Example:
+ *   typedef PackageRegistry<SensorPackage, ConfigPackage> AppPackages;
+ */
+template <typename... Packages>
+class PackageRegistry {
+public:
+    static_assert(detail::package_ports_unique<Packages...>(), "package port used more than once");
+    static_assert(detail::package_ids_unique<Packages...>(), "package ID used more than once");
+    static_assert(detail::package_ports_available<Packages...>(), "package port reserved by LoRaWAN or a built in package");
+
+    static constexpr size_t size() { return sizeof...(Packages); }
+
+    /**
+     * Package info by index, index must be less than size().
+     */
+    static constexpr lora::app::PackageInfo info(size_t index) {
+        const lora::app::PackageInfo table[] = { { Packages::PORT, Packages::ID, Packages::VERSION }..., { 0, 0, 0 } };
+        return table[index];
+    }
+
+    /**
+     * Indicates a package in the registry receives messages on the port.
+     */
+    static constexpr bool handles(uint8_t port) {
+        const uint8_t ports[] = { Packages::PORT..., 0 };
+        for (size_t i = 0; i < sizeof...(Packages); i++) {
+            if (ports[i] == port) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Get a package by type.
+     */
+    template <typename P>
+    P& get() {
+        return std::get<detail::package_index<P, Packages...>::value>(_packages).package();
+    }
+
+    /**
+     * Add every package to the app layer, call once after lora::app::init.
+     *
+     * @return first error from lora::app::addPackage or ERR_OK
+     */
+    lora::app::ErrorCode begin() {
+        return addAt<0>();
+    }
+
+private:
+    template <size_t I>
+    typename std::enable_if<(I < sizeof...(Packages)), lora::app::ErrorCode>::type
+    addAt() {
+        lora::app::ErrorCode err = lora::app::addPackage(&std::get<I>(_packages));
+        if (err != lora::app::ERR_OK) {
+            return err;
+        }
+        return addAt<I + 1>();
+    }
+
+    template <size_t I>
+    typename std::enable_if<(I == sizeof...(Packages)), lora::app::ErrorCode>::type
+    addAt() {
+        return lora::app::ERR_OK;
+    }
+
+    std::tuple<detail::package_slot<Packages>...> _packages;
+};
+
+#endif
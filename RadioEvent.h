@@ -4,6 +4,10 @@
 #include "dot_util.h"
 #include "mDotEvent.h"
 #include "LoraAppLayer.h"
+#include "ClockDiscipline.h"
+#include "SyncedClock.h"
+#include "AdrEstimator.h"
+#include "FragmentFilter.h"
 
 class RadioEvent : public mDotEvent
 {
@@ -15,7 +19,23 @@ public:
 
     virtual void PacketRx(uint8_t port, uint8_t *payload, uint16_t size, int16_t rssi, int16_t snr, lora::DownlinkControl ctrl, uint8_t slot, uint8_t retries, uint32_t address, uint32_t fcnt, bool dupRx) {
         mDotEvent::PacketRx(port, payload, size, rssi, snr, ctrl, slot, retries, address, fcnt, dupRx);
+        // Only unicast downlinks answer the last uplink, multicast and ping slot
+        // downlinks were not sent on its channel
+        if (!dupRx && address == dot->getSettings()->Session.Address) {
+            if (ctrl.Bits.Ack) {
+                lora::channel_quality.Acked(rssi, snr);
+            } else if (slot == lora::RX_1 || slot == lora::RX_2) {
+                lora::channel_quality.Received(rssi, snr);
+            }
+        }
+        // Repeated or redundant fragments are not worth queueing for the app layer
+        if (fragment_filter.drop(port, payload, size)) {
+            return;
+        }
         lora::app::ErrorCode err = lora::app::packetRx(payload, port, size, address);
+        if (err == lora::app::ERR_OK) {
+            fragment_filter.accepted(port, payload, size);
+        }
         if ((err != lora::app::ERR_OK) && (err != lora::app::ERR_UNKNOWN_PORT)) {
             std::string msg;
             switch (err) {
@@ -38,6 +58,11 @@ public:
         }
     }
 
+    virtual void MissedAck(uint8_t retries) {
+        mDotEvent::MissedAck(retries);
+        lora::channel_quality.Missed();
+    }
+
     /*!
      * MAC layer event callback prototype.
      *
@@ -85,6 +110,12 @@ public:
                      info->RxRssi, info->RxSnr, info->Energy, info->DemodMargin, info->NbGateways);
         }
 
+#if ADR_ESTIMATOR_ENABLED
+        if (flags->Bits.LinkCheck) {
+            adr_estimator.linkCheck(info->DemodMargin, info->NbGateways);
+        }
+#endif
+
         if (flags->Bits.Rx) {
 
             logInfo("Rx %d bytes", info->RxBufferSize);
@@ -100,10 +131,24 @@ public:
     }
 
 
+    virtual void TxDone(uint8_t dr) {
+        mDotEvent::TxDone(dr);
+        // DeviceTimeAns refers to the end of the uplink
+        _sinceTx.reset();
+        _sinceTx.start();
+    }
+
     virtual void ServerTime(uint32_t seconds, uint8_t sub_seconds) {
         mDotEvent::ServerTime(seconds, sub_seconds);
         lora::app::setClockOffset(seconds);
+        synced_clock.sync(seconds, sub_seconds, std::chrono::duration_cast<std::chrono::milliseconds>(_sinceTx.elapsed_time()).count());
+
+        // Fraction of the second is kept so the drift estimate is not limited by whole seconds
+        clock_discipline_update(time(NULL), (int64_t)synced_clock.nowMs() - (int64_t)synced_clock.rtcMs(), SYNCED_CLOCK_RESOLUTION_MS);
     }
+
+private:
+    LowPowerTimer _sinceTx;
 };
 
 #endif
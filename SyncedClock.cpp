@@ -0,0 +1,100 @@
+#include "SyncedClock.h"
+#include "ClockDiscipline.h"
+#include "LoraAppLayer.h"
+#include "MTSLog.h"
+
+SyncedClock synced_clock;
+
+// Seconds the low power timer may disagree with the RTC before it is distrusted
+static const int32_t TIMER_RTC_TOLERANCE = 2;
+
+
+SyncedClock::SyncedClock()
+    : _baseMs(0),
+      _baseRtc(0),
+      _set(false),
+      _rtcBase(0),
+      _rtcSet(false)
+{
+}
+
+void SyncedClock::sync(uint32_t seconds, uint8_t sub_seconds, uint32_t since_tx_ms) {
+    _timer.reset();
+    _timer.start();
+    _baseRtc = time(NULL);
+    _baseMs = (uint64_t)seconds * 1000 + ((uint32_t)sub_seconds * 1000) / 256 + since_tx_ms;
+    _set = true;
+
+    logDebug("Synced clock set to %lu.%03lu, %lu ms after uplink", (uint32_t)(_baseMs / 1000), (uint32_t)(_baseMs % 1000), since_tx_ms);
+}
+
+void SyncedClock::align(time_t synced_s) {
+    int64_t diff = (int64_t)synced_s * 1000 - (int64_t)nowMs();
+
+    // Whole second time is truncated, only re-align when it moved outside the current second
+    if (!valid() || diff <= -1000 || diff >= 1000) {
+        _timer.reset();
+        _timer.start();
+        _baseRtc = time(NULL);
+        _baseMs = (uint64_t)synced_s * 1000;
+        _set = true;
+
+        logDebug("Synced clock aligned to %lu", (uint32_t)synced_s);
+    }
+}
+
+bool SyncedClock::valid() {
+    if (!_set) {
+        return false;
+    }
+
+    int64_t elapsed_s = std::chrono::duration_cast<std::chrono::seconds>(_timer.elapsed_time()).count();
+    int64_t rtc_s = time(NULL) - _baseRtc;
+
+    return (rtc_s - elapsed_s) <= TIMER_RTC_TOLERANCE && (elapsed_s - rtc_s) <= TIMER_RTC_TOLERANCE;
+}
+
+bool SyncedClock::isPrecise() {
+    return valid();
+}
+
+uint64_t SyncedClock::nowMs() {
+    if (!valid()) {
+        return (uint64_t)lora::app::syncedTime() * 1000;
+    }
+
+    uint64_t elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(_timer.elapsed_time()).count();
+    time_t rtc = time(NULL);
+
+    // Timer runs from the same crystal as the RTC, correct it with the estimated drift
+    int64_t drift_ms = clock_discipline.predictOffset(rtc) - clock_discipline.predictOffset(_baseRtc);
+
+    return _baseMs + elapsed_ms + drift_ms;
+}
+
+int64_t SyncedClock::msUntil(time_t synced_s) {
+    return (int64_t)synced_s * 1000 - (int64_t)nowMs();
+}
+
+uint64_t SyncedClock::rtcMs() {
+    time_t rtc = time(NULL);
+
+    if (_rtcSet) {
+        int64_t elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(_rtcTimer.elapsed_time()).count();
+        int64_t rtc_s = rtc - _rtcBase;
+
+        if ((rtc_s - elapsed_ms / 1000) <= TIMER_RTC_TOLERANCE && (elapsed_ms / 1000 - rtc_s) <= TIMER_RTC_TOLERANCE) {
+            return (uint64_t)_rtcBase * 1000 + elapsed_ms;
+        }
+
+        // Earlier corrections were measured from the old start of the timer
+        clock_discipline.reset();
+    }
+
+    _rtcTimer.reset();
+    _rtcTimer.start();
+    _rtcBase = rtc;
+    _rtcSet = true;
+
+    return (uint64_t)rtc * 1000;
+}
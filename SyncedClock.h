@@ -0,0 +1,83 @@
+#ifndef __SYNCED_CLOCK_H__
+#define __SYNCED_CLOCK_H__
+
+#include "mbed.h"
+#include <cstdint>
+#include <ctime>
+
+// Accuracy in milliseconds of the synced clock after DeviceTimeAns, the time is
+// given in 1/256 s steps and the end of the uplink is only known to a few ms
+#ifndef SYNCED_CLOCK_RESOLUTION_MS
+#define SYNCED_CLOCK_RESOLUTION_MS          (20)
+#endif
+
+/**
+ * Millisecond resolution clock synchronized with server GPS time.
+ *
+ * The clock is set from DeviceTimeAns including the fractional second and
+ * runs from a low power timer so it keeps counting through sleep.  Falls back
+ * to lora::app::syncedTime() when it has not been set or the timer did not
+ * keep time with the RTC, such as after deep sleep.
+ */
+class SyncedClock {
+public:
+    SyncedClock();
+
+    /**
+     * Set the clock from server time.  DeviceTimeAns gives the time at the
+     * end of the uplink that carried DeviceTimeReq, the time since then is
+     * added.
+     *
+     * @param seconds       GPS seconds
+     * @param sub_seconds   Fractional second in 1/256 s steps
+     * @param since_tx_ms   Milliseconds since the end of the uplink
+     */
+    void sync(uint32_t seconds, uint8_t sub_seconds, uint32_t since_tx_ms);
+
+    /**
+     * Re-align with the whole second synced time if it was adjusted.  Sub-second
+     * precision is kept while the two agree.
+     *
+     * @param synced_s      Time from lora::app::syncedTime()
+     */
+    void align(time_t synced_s);
+
+    /**
+     * Indicates the clock holds sub-second time.
+     */
+    bool isPrecise();
+
+    /**
+     * Synced time in milliseconds since the GPS epoch.
+     */
+    uint64_t nowMs();
+
+    /**
+     * Milliseconds until the given synced time, negative if in the past.
+     */
+    int64_t msUntil(time_t synced_s);
+
+    /**
+     * RTC time in milliseconds.  The RTC only gives whole seconds, the
+     * fraction is counted by a low power timer so differences between calls
+     * keep ms resolution.  Clock discipline corrections are forgotten when
+     * the timer has to be restarted.
+     */
+    uint64_t rtcMs();
+
+private:
+    bool valid();
+
+    LowPowerTimer _timer;
+    uint64_t _baseMs;
+    time_t _baseRtc;
+    bool _set;
+
+    LowPowerTimer _rtcTimer;
+    time_t _rtcBase;
+    bool _rtcSet;
+};
+
+extern SyncedClock synced_clock;
+
+#endif
@@ -0,0 +1,251 @@
+#include "WakeTimeline.h"
+#include "SyncedClock.h"
+#include "MulticastScheduler.h"
+#include "ClassBSchedule.h"
+#include "dot_util.h"
+
+WakeTimeline wake_timeline;
+
+static const char* SOURCE_NAMES[WakeTimeline::WAKE_SOURCES] = {
+    "beacon",
+    "multicast start",
+    "ping slot",
+    "uplink",
+    "poll"
+};
+
+
+WakeTimeline::WakeTimeline()
+    : _uplinkDue(0),
+      _heldUntil(0),
+      _heldSince(-1),
+      _conflicts(0),
+      _source(WAKE_SOURCES)
+{
+    _timer.start();
+}
+
+const char* WakeTimeline::sourceName(uint8_t source) {
+    return (source < WAKE_SOURCES) ? SOURCE_NAMES[source] : "none";
+}
+
+int64_t WakeTimeline::lengthMs(uint8_t source) {
+    switch (source) {
+        case WAKE_BEACON:
+            return lora::CLASS_B_BEACON_RESERVED_MS;
+        case WAKE_PING_SLOT:
+            return lora::CLASS_B_SLOT_MS;
+        case WAKE_MULTICAST_START:
+            return WAKE_TIMELINE_CONFLICT_MS;
+        default:
+            return 0;
+    }
+}
+
+int64_t WakeTimeline::nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(_timer.elapsed_time()).count();
+}
+
+void WakeTimeline::setUplinkDue(int64_t ms) {
+    _uplinkDue = nowMs() + ms;
+}
+
+uint8_t WakeTimeline::collect(WakeEvent* events) {
+    uint8_t count = 0;
+
+    if (lora::class_b_schedule.Valid() && lora::app::getClockSynced() && dot->getClass() == "B") {
+        uint64_t now = synced_clock.nowMs();
+        uint64_t beacon = (uint64_t)lora::class_b_schedule.BeaconTime() * 1000;
+        uint64_t period = (uint64_t)lora::class_b_schedule.BeaconPeriod() * 1000;
+
+        if (now >= beacon) {
+            uint64_t since = now - beacon;
+
+            events[count].source = WAKE_BEACON;
+            events[count].session = 0;
+            events[count].ms = (int64_t)((since / period + 1) * period - since);
+            count++;
+
+            // Ping slot offsets are only known for the period of the last beacon
+            uint8_t session = 0;
+            int32_t slot = (since < period) ? lora::class_b_schedule.NextSlotMs((uint32_t)since, session) : -1;
+            if (slot >= 0) {
+                events[count].source = WAKE_PING_SLOT;
+                events[count].session = session;
+                events[count].ms = slot - (int64_t)since;
+                count++;
+            }
+        }
+    }
+
+    int64_t start = multicast_scheduler.msUntilStart();
+    if (start < 0 && lora::app::fota().ready() && lora::app::fota().timeToStart() > 0) {
+        // Scheduler has nothing armed, fall back to the second resolution start time
+        start = (int64_t)lora::app::fota().timeToStart() * 1000;
+    }
+    if (start >= 0) {
+        events[count].source = WAKE_MULTICAST_START;
+        events[count].session = multicast_scheduler.pendingGroup();
+        events[count].ms = start;
+        count++;
+    }
+
+    int64_t uplink = std::max(_uplinkDue, _heldUntil) - nowMs();
+    events[count].source = WAKE_UPLINK;
+    events[count].session = 0;
+    events[count].ms = (uplink > 0) ? uplink : 0;
+    count++;
+
+    events[count].source = WAKE_POLL;
+    events[count].session = 0;
+    events[count].ms = lora::app::idle() ? WAKE_TIMELINE_IDLE_MS : WAKE_TIMELINE_POLL_MS;
+    count++;
+
+    return count;
+}
+
+bool WakeTimeline::macOnly(uint8_t source) {
+    // Beacons and ping slots are opened by the MAC, the application has nothing to do for them
+    return source == WAKE_BEACON || source == WAKE_PING_SLOT;
+}
+
+WakeEvent WakeTimeline::resolve(uint8_t* dropped, int64_t* mac_ms) {
+    WakeEvent events[WAKE_SOURCES];
+    uint8_t count = collect(events);
+    int8_t best = -1;
+
+    if (mac_ms != NULL) {
+        *mac_ms = -1;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (macOnly(events[i].source)) {
+            if (mac_ms != NULL && (*mac_ms < 0 || events[i].ms < *mac_ms)) {
+                *mac_ms = events[i].ms;
+            }
+        } else if (best < 0 || events[i].ms < events[best].ms) {
+            best = i;
+        }
+    }
+
+    // Prefer a higher priority obligation due at nearly the same time
+    for (uint8_t i = 0; i < count; i++) {
+        if (!macOnly(events[i].source) && events[i].source < events[best].source && events[i].ms - events[best].ms < WAKE_TIMELINE_CONFLICT_MS) {
+            best = i;
+        }
+    }
+
+    if (dropped != NULL) {
+        *dropped = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            if (i != best && !macOnly(events[i].source) && events[i].source < WAKE_UPLINK && events[i].ms - events[best].ms < WAKE_TIMELINE_CONFLICT_MS) {
+                (*dropped)++;
+            }
+        }
+    }
+
+    return events[best];
+}
+
+WakeEvent WakeTimeline::next() {
+    return resolve(NULL, NULL);
+}
+
+bool WakeTimeline::uplinkClear(uint8_t bytes) {
+    int64_t now = nowMs();
+
+    if (now < _heldUntil) {
+        return false;
+    }
+
+    WakeEvent events[WAKE_SOURCES];
+    uint8_t count = collect(events);
+
+    // Receive windows open after the transmit ends, RX2 one second after RX1
+    int64_t rx1 = (int64_t)dot->getTimeOnAir(bytes) + (int64_t)dot->getRxDelay() * 1000;
+    int64_t rx2 = rx1 + 1000;
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (events[i].source >= WAKE_UPLINK) {
+            continue;
+        }
+
+        int64_t start = events[i].ms;
+        int64_t end = start + lengthMs(events[i].source);
+        bool overlap = (start < rx1 + WAKE_TIMELINE_RX_WINDOW_MS && rx1 < end) ||
+                       (start < rx2 + WAKE_TIMELINE_RX_WINDOW_MS && rx2 < end);
+
+        if (!overlap) {
+            continue;
+        }
+
+        if (_heldSince < 0) {
+            _heldSince = now;
+        } else if (now - _heldSince >= WAKE_TIMELINE_MAX_HOLD_MS) {
+            logInfo("Uplink held back %lu ms, sending anyway", (uint32_t)(now - _heldSince));
+            break;
+        }
+
+        // Check again once the blocking obligation is over
+        _heldUntil = now + end;
+        logDebug("Uplink held back for %s in %lu ms", sourceName(events[i].source), (uint32_t)start);
+        return false;
+    }
+
+    _heldSince = -1;
+    _heldUntil = 0;
+    return true;
+}
+
+void WakeTimeline::sleep() {
+    uint8_t dropped = 0;
+    int64_t mac_ms = -1;
+    WakeEvent event = resolve(&dropped, &mac_ms);
+    _conflicts += dropped;
+
+    if (event.source == WAKE_MULTICAST_START && _source != WAKE_MULTICAST_START
+        && lora::app::fota().ready() && lora::app::fota().timeToStart() > 0) {
+        logInfo("FOTA starting in %d seconds", lora::app::fota().timeToStart());
+    }
+    _source = event.source;
+
+    int64_t ms = event.ms;
+    if (event.source < WAKE_UPLINK) {
+        ms -= WAKE_TIMELINE_GUARD_MS;
+    }
+
+    if (ms <= 0) {
+        // Inside the guard of a session start, stay awake until it is over
+        int64_t over = event.ms + lengthMs(event.source);
+        if (over > 0) {
+            ThisThread::sleep_for(std::chrono::milliseconds(over));
+        }
+        return;
+    }
+
+    // Nothing is listening until the next obligation when idle or waiting for a session to start
+    bool stop = lora::app::idle() || (lora::app::fota().ready() && lora::app::fota().timeToStart() > 0);
+
+    if (stop && !dot->getIsIdle()) {
+        // Let the radio finish its transmit and receive windows before stopping the MCU
+        ThisThread::sleep_for(100ms);
+        return;
+    }
+
+    // MCU has to be running for the MAC to open the next beacon or ping slot
+    int64_t stop_ms = ms;
+    if (mac_ms >= 0) {
+        stop_ms = std::min<int64_t>(stop_ms, mac_ms - WAKE_TIMELINE_GUARD_MS);
+    }
+
+    if (stop && stop_ms >= WAKE_TIMELINE_RTC_MIN_MS) {
+        // RTC alarm only has second resolution, wake early and sleep the rest on the next pass
+        uint32_t seconds = (uint32_t)(stop_ms / 1000) - 1;
+        logDebug("Sleeping %lu s until %s", seconds, sourceName(event.source));
+        dot->sleep(seconds, mDot::RTC_ALARM, false);
+        lora::app::fixEventQueue();
+    } else {
+        // MAC keeps running and opens any class B windows in between
+        ThisThread::sleep_for(std::chrono::milliseconds(ms));
+    }
+}
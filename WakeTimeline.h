@@ -0,0 +1,142 @@
+#ifndef __WAKE_TIMELINE_H__
+#define __WAKE_TIMELINE_H__
+
+#include "mbed.h"
+#include <cstdint>
+
+// Milliseconds woken before a radio obligation, covers clock error and the time to wake up
+#ifndef WAKE_TIMELINE_GUARD_MS
+#define WAKE_TIMELINE_GUARD_MS              (100)
+#endif
+
+// Obligations closer together than this are in conflict and only the higher priority one is kept
+#ifndef WAKE_TIMELINE_CONFLICT_MS
+#define WAKE_TIMELINE_CONFLICT_MS           (100)
+#endif
+
+// Time each receive window after an uplink is assumed to keep the radio busy
+#ifndef WAKE_TIMELINE_RX_WINDOW_MS
+#define WAKE_TIMELINE_RX_WINDOW_MS          (500)
+#endif
+
+// Longest an uplink is held back for receive obligations before it is sent anyway
+#ifndef WAKE_TIMELINE_MAX_HOLD_MS
+#define WAKE_TIMELINE_MAX_HOLD_MS           (10000)
+#endif
+
+// Longest sleep while the app layer is idle, or has work pending
+#ifndef WAKE_TIMELINE_IDLE_MS
+#define WAKE_TIMELINE_IDLE_MS               (10000)
+#endif
+
+#ifndef WAKE_TIMELINE_POLL_MS
+#define WAKE_TIMELINE_POLL_MS               (1000)
+#endif
+
+// Shortest sleep worth stopping the MCU on the RTC alarm, which only has second resolution
+#ifndef WAKE_TIMELINE_RTC_MIN_MS
+#define WAKE_TIMELINE_RTC_MIN_MS            (2000)
+#endif
+
+/**
+ * Next time the application has to be awake.
+ */
+struct WakeEvent {
+    uint8_t source;             // WakeTimeline::Source
+    uint8_t session;            // Multicast group, lora::CLASS_B_UNICAST or 0
+    int64_t ms;                 // Milliseconds from now
+};
+
+/**
+ * Single timeline of everything the device has to wake for.
+ *
+ * Class B beacons and ping slots are read from lora::class_b_schedule,
+ * multicast session starts from the multicast scheduler, and the next
+ * uplink and app layer polling from the application.  Obligations are
+ * ordered by time.  When two fall within WAKE_TIMELINE_CONFLICT_MS the one
+ * with the lower Source value wins, so the choice does not depend on the
+ * order they were found in.  Uplinks are held back while a receive
+ * obligation would overlap their RX1 or RX2 window, for at most
+ * WAKE_TIMELINE_MAX_HOLD_MS so frequent ping slots cannot starve them.
+ *
+ * Beacons and ping slots are opened by the MAC, so they never wake the
+ * application thread.  They only hold uplinks back and keep the MCU from
+ * being stopped across them.
+ */
+class WakeTimeline {
+public:
+    /**
+     * Obligations in priority order, highest first
+     */
+    enum Source {
+        WAKE_BEACON = 0,
+        WAKE_MULTICAST_START,
+        WAKE_PING_SLOT,
+        WAKE_UPLINK,
+        WAKE_POLL,
+        WAKE_SOURCES
+    };
+
+    WakeTimeline();
+
+    /**
+     * Set when the next uplink is due.
+     *
+     * @param ms            Milliseconds from now, zero or negative if due
+     */
+    void setUplinkDue(int64_t ms);
+
+    /**
+     * Next obligation the application thread wakes for after conflicts are resolved.
+     */
+    WakeEvent next();
+
+    /**
+     * Milliseconds until the device has to be awake.
+     */
+    int64_t msUntilWake() { return next().ms; }
+
+    /**
+     * Indicates an uplink sent now would not have its receive windows
+     * overlap a receive obligation.  While held the uplink is rescheduled
+     * to the end of the blocking obligation.
+     *
+     * @param bytes         Size of the uplink payload
+     */
+    bool uplinkClear(uint8_t bytes = 0);
+
+    /**
+     * Sleep until the next obligation.  The MCU is stopped on the RTC alarm
+     * when nothing is listening in between, otherwise the thread sleeps.
+     */
+    void sleep();
+
+    /**
+     * Obligations dropped because a higher priority one was due at the same time.
+     */
+    uint32_t conflicts() const { return _conflicts; }
+
+    /**
+     * Name of an obligation for logging.
+     */
+    static const char* sourceName(uint8_t source);
+
+private:
+    static int64_t lengthMs(uint8_t source);
+    static bool macOnly(uint8_t source);
+
+    uint8_t collect(WakeEvent* events);
+    WakeEvent resolve(uint8_t* dropped, int64_t* mac_ms);
+    int64_t nowMs();
+
+    LowPowerTimer _timer;
+    int64_t _uplinkDue;         // Time on _timer the next uplink is due
+    int64_t _heldUntil;         // Time on _timer a held uplink is checked again
+    int64_t _heldSince;         // Time on _timer the uplink was first held, negative if not held
+    uint32_t _conflicts;
+    uint8_t _source;            // Source of the last wake target
+};
+
+extern WakeTimeline wake_timeline;
+
+#endif
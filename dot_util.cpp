@@ -344,6 +344,62 @@ void join_network() {
             }
         }
     }
+
+    // channels of the new session come from the join accept, learn their quality again
+    lora::channel_quality.Reset();
+
+    // remember the sub-band that accepted the join for the next search
+    if (lora::join_strategy.Accepted()) {
+        join_strategy_save();
+    }
+}
+
+void join_strategy_save() {
+    lora::JoinStrategy::History history = lora::join_strategy.GetHistory();
+
+    if (!dot->saveUserFile(JOIN_STRATEGY_FILE, &history, sizeof(history))) {
+        logError("failed to save join sub-band history");
+    }
+}
+
+void join_strategy_restore() {
+    lora::JoinStrategy::History history;
+
+    if (dot->readUserFile(JOIN_STRATEGY_FILE, &history, sizeof(history)) && lora::join_strategy.SetHistory(history)) {
+        logInfo("join sub-band search starts at %d", lora::join_strategy.SubBand(0));
+    }
+}
+
+void join_backoff_save() {
+    uint32_t words[lora::JOIN_BACKOFF_STATE_WORDS];
+
+    lora::join_backoff.Pack(words);
+
+    for (uint8_t i = 0; i < lora::JOIN_BACKOFF_STATE_WORDS; i++) {
+        if (!dot->writeUserBackupRegister(JOIN_BACKOFF_BACKUP_REGISTER + i, words[i])) {
+            logError("failed to save join backoff state");
+            return;
+        }
+    }
+}
+
+void join_backoff_restore() {
+    uint32_t words[lora::JOIN_BACKOFF_STATE_WORDS];
+
+    for (uint8_t i = 0; i < lora::JOIN_BACKOFF_STATE_WORDS; i++) {
+        if (!dot->readUserBackupRegister(JOIN_BACKOFF_BACKUP_REGISTER + i, words[i])) {
+            return;
+        }
+    }
+
+    if (lora::join_backoff.Unpack(words)) {
+        logInfo("restored join backoff, time-off max %lus", lora::join_backoff.TimeOffMax);
+    }
+
+    // only valid once, clear so a later cold start does not pick it up
+    for (uint8_t i = 0; i < lora::JOIN_BACKOFF_STATE_WORDS; i++) {
+        dot->writeUserBackupRegister(JOIN_BACKOFF_BACKUP_REGISTER + i, 0);
+    }
 }
 
 void sleep_wake_rtc_only(bool deepsleep) {
@@ -375,6 +431,11 @@ void sleep_wake_rtc_only(bool deepsleep) {
 	sleep_configure_io();
     }
     
+    // application restarts after deepsleep, keep join backoff progress in backup registers
+    if (deepsleep) {
+        join_backoff_save();
+    }
+
     // go to sleep/deepsleep for delay_s seconds and wake using the RTC alarm
     dot->sleep(delay_s, mDot::RTC_ALARM, deepsleep);
 
@@ -430,6 +491,11 @@ void sleep_wake_interrupt_only(bool deepsleep) {
 	sleep_configure_io();
     }
     
+    // application restarts after deepsleep, keep join backoff progress in backup registers
+    if (deepsleep) {
+        join_backoff_save();
+    }
+
     // go to sleep/deepsleep and wake on rising edge of configured wake pin (only the WAKE pin in deepsleep)
     // since we're not waking on the RTC alarm, the interval is ignored
     dot->sleep(0, mDot::INTERRUPT, deepsleep);
@@ -492,6 +558,11 @@ void sleep_wake_rtc_or_interrupt(bool deepsleep) {
 	sleep_configure_io();
     }
     
+    // application restarts after deepsleep, keep join backoff progress in backup registers
+    if (deepsleep) {
+        join_backoff_save();
+    }
+
     // go to sleep/deepsleep and wake using the RTC alarm after delay_s seconds or rising edge of configured wake pin (only the WAKE pin in deepsleep)
     // whichever comes first will wake the xDot
     dot->sleep(delay_s, mDot::RTC_ALARM_OR_INTERRUPT, deepsleep);
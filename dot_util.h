@@ -10,6 +10,16 @@
 #include "version.h"
 #include "LoraAppLayer.h"
 
+// First of the user backup registers holding join backoff state over deepsleep
+#ifndef JOIN_BACKOFF_BACKUP_REGISTER
+#define JOIN_BACKOFF_BACKUP_REGISTER    (mDot::UBR8)
+#endif
+
+// User file holding the sub-bands that accepted joins
+#ifndef JOIN_STRATEGY_FILE
+#define JOIN_STRATEGY_FILE              "join_strategy"
+#endif
+
 extern mDot* dot;
 
 lora::ChannelPlan* create_channel_plan();
@@ -28,6 +38,14 @@ void update_network_link_check_config(uint8_t link_check_count, uint8_t link_che
 
 void join_network();
 
+void join_backoff_save();
+
+void join_backoff_restore();
+
+void join_strategy_save();
+
+void join_strategy_restore();
+
 void sleep_wake_rtc_only(bool deepsleep);
 
 void sleep_wake_interrupt_only(bool deepsleep);
@@ -2,6 +2,14 @@
 #include "dot_util.h"
 #include "RadioEvent.h"
 #include "LoraAppLayer.h"
+#include "ClockDiscipline.h"
+#include "SyncedClock.h"
+#include "MulticastScheduler.h"
+#include "AppEventRing.h"
+#include "AppPackages.h"
+#include "AdrEstimator.h"
+#include "WakeTimeline.h"
+#include "FotaEarlyExit.h"
 
 #ifdef CONFIG_LORA_NETWORK_ID
 static uint8_t network_id[] = CONFIG_LORA_NETWORK_ID;
@@ -41,6 +49,7 @@ static const uint8_t FOTA_SIG_PUB_KEY[] = CONFIG_FOTA_SIG_PUB_KEY;
 
 mDot* dot = NULL;
 lora::ChannelPlan* plan = NULL;
+AppPackages app_packages;
 
 mbed::UnbufferedSerial debug_port(USBTX, USBRX, LOG_DEFAULT_BAUD_RATE);
 
@@ -96,18 +105,40 @@ mbed::BlockDevice * mdot_override_external_block_device()
 #endif
 
 
-void lora_app_event(lora::app::EventNotification en)
+void lora_app_event(const AppEvent& en)
 {
     const char* desc = lora_app_event_code_to_str(en.code);
-    logInfo("LoRa App Event : %d : %s", (uint32_t)en.at, desc);
+    if (en.count > 1) {
+        logInfo("LoRa App Event : %d-%d : %s x%u", (uint32_t)en.first, (uint32_t)en.last, desc, en.count);
+    } else {
+        logInfo("LoRa App Event : %d : %s", (uint32_t)en.last, desc);
+    }
 
     switch (en.code) {
         case lora::app::EVENT_CLOCK_SYNCHRONIZED:
         {
             time_t now = lora::app::syncedTime();
             logInfo("Time synced to %d", (uint32_t)now);
+            // Correction was already recorded with ms resolution from ServerTime
+            synced_clock.align(now);
+            multicast_scheduler.reschedule();
             break;
         }
+        case lora::app::EVENT_MULTICAST_SESSION_SETUP:
+            multicast_scheduler.reschedule();
+            break;
+        case lora::app::EVENT_MULTICAST_SESSION_STARTED:
+        case lora::app::EVENT_MULTICAST_SESSION_CLOSED:
+            // Arm the session following the one that started or closed
+            multicast_scheduler.reschedule();
+            break;
+        case lora::app::EVENT_FOTA_SESSION_CREATED:
+            fota_early_exit.reset();
+            break;
+        case lora::app::EVENT_FOTA_FILE_RECEIVED:
+            // Stop listening for the rest of the session once the file is rebuilt
+            fota_early_exit.fileReceived();
+            break;
         default:
             break;
     }
@@ -129,6 +160,12 @@ int main() {
     dot = mDot::getInstance(plan);
     assert(dot);
 
+    // Continue the join backoff schedule if waking from deepsleep
+    join_backoff_restore();
+
+    // Search sub-bands that accepted joins before first
+    join_strategy_restore();
+
     logInfo("mbed-os library version: %d.%d.%d", MBED_MAJOR_VERSION, MBED_MINOR_VERSION, MBED_PATCH_VERSION);
 
     // For test only.  Frag session count should not be reset normally.
@@ -159,7 +196,13 @@ int main() {
     lora::app::fota().setValidator(new lora::app::SuitManifestValidatorMbedTlsSha256());
 #endif
 
-    lora::app::attach(&lora_app_event);
+    // Notifications are queued by the app layer thread and handled from the shared event queue
+    app_event_ring.subscribe(callback(&lora_app_event));
+    lora::app::attach(callback(&app_event_ring, &AppEventRing::push));
+
+    if (app_packages.begin() != lora::app::ERR_OK) {
+        logError("failed to add application packages");
+    }
 
     lora::app::begin();
 
@@ -224,38 +267,43 @@ int main() {
 
     if (!dot->getNetworkJoinStatus()) {
         join_network();
+#if ADR_ESTIMATOR_ENABLED
+        adr_estimator.reset();
+#endif
     }
 
     std::chrono::milliseconds send_interval = 30s;
 
     while (true) {
-        if (send_timer.elapsed_time() > send_interval) {
+        // Hold the uplink back while a beacon, ping slot or session start falls in its receive windows
+        if (send_timer.elapsed_time() > send_interval && wake_timeline.uplinkClear(sizeof(n))) {
             send_timer.reset();
             tx_data.push_back((n >> 8) & 0xFF);
             tx_data.push_back(n & 0xFF);
             n++;
+#if ADR_ESTIMATOR_ENABLED
+            adr_estimator.update();
+#endif
             send_data(tx_data);
             tx_data.clear();
+
+            if (n % lora::CHANNEL_QUALITY_AGE_TX == 0) {
+                lora::channel_quality.Log();
+            }
         }
 
-        ThisThread::sleep_for(1s);
+        clock_discipline_poll(time(NULL));
 
-        if (lora::app::idle()) {
-            send_interval = 30s;
-            dot->sleep(10, mDot::RTC_ALARM, false);
-        } else if (lora::app::fota().ready() && (lora::app::fota().timeToStart() > 0)) {
-            logInfo("FOTA starting in %d seconds", lora::app::fota().timeToStart());
-            while (!dot->getIsIdle()) {
-                ThisThread::sleep_for(100ms);
-            }
-            dot->sleep(lora::app::fota().timeToStart(), mDot::RTC_ALARM, false);
-        } else if (lora::app::fota().active()) {
+        if (lora::app::fota().active() && !fota_early_exit.done()) {
             // Reduce uplinks during FOTA, dot cannot receive while transmitting
             // Too many lost packets will cause FOTA to fail
             send_interval = 300s;
         } else {
             send_interval = 30s;
         }
+
+        wake_timeline.setUplinkDue(std::chrono::duration_cast<std::chrono::milliseconds>(send_interval - send_timer.elapsed_time()).count());
+        wake_timeline.sleep();
     }
 
     return 0;
@@ -19,6 +19,15 @@
 #include "Lora.h"
 #include "SxRadio.h"
 #include "ChannelPlan.h"
+#include "ChannelSelector.h"
+#include "JoinBackoffState.h"
+#include "JoinStrategy.h"
+#include "Crc16.h"
+#include "ChannelQuality.h"
+#include "ClearChannelSearch.h"
+#include "ClassBSchedule.h"
+#include "RxConfigCache.h"
+#include "TimeOnAirTable.h"
 #include <vector>
 
 namespace lora {
@@ -151,6 +160,21 @@ namespace lora {
              */
             virtual uint8_t SetTxConfig();
 
+            /**
+             * Set the SxRadio rx config provided window, skipped if a continuous window is reopened unchanged
+             * @param window to be opened
+             * @param continuous keep window open
+             * @param wnd_growth factor to increase the rx window by
+             * @param pad_ms time in milliseconds to add to computed window size
+             * @param id multicast session of the window
+             * @return LORA_OK
+             */
+            virtual uint8_t SetRxConfig(uint8_t window,
+                                        bool continuous,
+                                        uint16_t wnd_growth = 1,
+                                        uint16_t pad_ms = 0,
+                                        int8_t id = 0);
+
             /**
              * Set frequency sub band if supported by plan
              * @param sub_band
@@ -230,6 +254,14 @@ namespace lora {
              */
             virtual uint8_t ValidateAdrConfiguration();
 
+            /**
+             * Get the time on air of a packet, uplink datarates use a precomputed table
+             * @param bytes PHY payload length
+             * @param cfg TX or RX radio settings
+             * @return ms of time on air
+             */
+            virtual uint32_t GetTimeOnAir(uint8_t bytes, RadioCfg_t cfg = TX_RADIO_CFG);
+
             /**
              * Get the time the radio must be off air to comply with regulations
              * Time to wait may be dependent on duty-cycle restrictions per channel
@@ -315,11 +347,16 @@ namespace lora {
 
             static const uint8_t AU915_TX_POWERS[15];                   //!< List of available tx powers
             static const uint8_t AU915_MAX_PAYLOAD_SIZE[];              //!< List of max payload sizes for each datarate
+            static const TimeOnAirTable<7> AU915_TIME_ON_AIR;           //!< Uplink time on air for each datarate and payload length
             static const uint8_t AU915_MAX_PAYLOAD_SIZE_400[];          //!< List of max payload sizes for each datarate
             static const uint8_t AU915_MAX_PAYLOAD_SIZE_REPEATER[];     //!< List of repeater compatible max payload sizes for each datarate
             static const uint8_t AU915_MAX_PAYLOAD_SIZE_REPEATER_400[]; //!< List of repeater compatible max payload sizes for each datarate
             static const uint8_t MAX_ERP_VALUES[];                      //!< Lookup table for Max EIRP (dBm) codes
 
+            ChannelSelector _channelSelector;                           //!< Channels eligible for transmit at the current datarate
+            ClearChannelSearch _clearChannelSearch;                     //!< Listen before talk over the available channels
+            RxConfigCache _rxConfigCache;                               //!< Last continuous receive window configured
+
             typedef struct __attribute__((packed)) {
                 uint8_t RFU1[5];
                 uint8_t Time[4];
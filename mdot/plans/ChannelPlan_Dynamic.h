@@ -0,0 +1,598 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#ifndef __CHANNEL_PLAN_DYNAMIC_H__
+#define __CHANNEL_PLAN_DYNAMIC_H__
+
+#include "Lora.h"
+#include "SxRadio.h"
+#include "ChannelPlan.h"
+#include "ChannelSelector.h"
+#include "DutyBandTable.h"
+#include "DutyCycleSchedule.h"
+#include "JoinBackoffState.h"
+#include "Crc16.h"
+#include "ChannelQuality.h"
+#include "ClearChannelSearch.h"
+#include "ClassBSchedule.h"
+#include "RxConfigCache.h"
+#include <algorithm>
+#include <climits>
+#include <string.h>
+
+namespace lora {
+
+    /**
+     * Frequencies where the duty cycle is lifted for low power transmissions
+     */
+    enum {
+        VAR_FREQ_NONE = 0,      //!< Duty cycle always applies
+        VAR_FREQ_FIXED,         //!< Region::VAR_FREQ_MIN to Region::VAR_FREQ_MAX
+        VAR_FREQ_PLAN           //!< Plan minimum to maximum frequency
+    };
+
+    /**
+     * Uplink channel selection, duty cycle, join backoff and beacon decoding
+     * shared by the dynamic channel plans.
+     *
+     * Region differences come from a descriptor type so conditions that do not
+     * apply to a region are constant and compile out.  The descriptor provides:
+     *
+     *   JOIN_TIME              time-on-air in ms kept back for the last join attempt of a day
+     *   VAR_FREQ_RULE          VAR_FREQ_NONE, VAR_FREQ_FIXED or VAR_FREQ_PLAN
+     *   VAR_FREQ_MIN/MAX       frequency range for VAR_FREQ_FIXED
+     *   LBT_SKIPS_DUTY_CYCLE   duty cycle is not enforced when listen before talk is enabled
+     *   BEACON_RFU1/RFU2       sizes of the reserved beacon fields
+     */
+    template <typename Region>
+    class ChannelPlan_Dynamic : public lora::ChannelPlan {
+        public:
+            static const uint8_t BEACON_SIZE = Region::BEACON_RFU1 + 4 + 2 + 7 + Region::BEACON_RFU2 + 2;
+
+            ChannelPlan_Dynamic(SxRadio* radio, Settings* settings) : ChannelPlan(radio, settings) {
+                memset(_channelBand, -1, sizeof(_channelBand));
+            }
+
+            using ChannelPlan::GetDutyBand;
+
+            /**
+             * Get index of duty band containing a frequency
+             * @param freq frequency in Hz
+             * @return index of duty band or -1 if not found
+             */
+            virtual int8_t GetDutyBand(uint32_t freq) {
+                return _dutyBandTable.Find(freq);
+            }
+
+            /**
+             * Add duty band and rebuild the band lookups
+             * @param index of duty band or -1 to append
+             * @param band DutyBand definition
+             * @return LORA_OK or LORA_ERROR if the index is past the bands the schedule tracks
+             */
+            virtual uint8_t AddDutyBand(int8_t index, DutyBand band) {
+                size_t slot = index < 0 ? _dutyBands.size() : (size_t)index;
+
+                if (slot >= DUTY_CYCLE_SCHEDULE_BANDS) {
+                    return LORA_ERROR;
+                }
+
+                uint8_t ret = ChannelPlan::AddDutyBand(index, band);
+
+                _dutySchedule.Set(slot, 0);
+
+                _dutyBandTable.Build(_dutyBands);
+                for (size_t i = 0; i < _channels.size(); i++) {
+                    CacheChannelDutyBand(i);
+                }
+
+                return ret;
+            }
+
+            /**
+             * Get index of duty band containing a channel, cached when the channel is added
+             * @param channel index of channel
+             * @return index of duty band or -1 if not found
+             */
+            int8_t GetChannelDutyBand(uint8_t channel) {
+                if (channel < CHANNEL_SELECTOR_MAX_CHANNELS) {
+                    return _channelBand[channel];
+                }
+                return GetDutyBand(GetChannel(channel).Frequency);
+            }
+
+            /**
+             * Set the time off air for the given duty band
+             * @param band index
+             * @param timeoff time off air in ms
+             */
+            virtual void SetDutyBandTimeOff(uint8_t band, uint32_t timeoff) {
+                ChannelPlan::SetDutyBandTimeOff(band, timeoff);
+                _dutySchedule.Set(band, timeoff != 0 ? _dutySchedule.Now() + timeoff : 0);
+            }
+
+            /**
+             * Get the time off air for the given duty band
+             * @param band index
+             * @return time off air in ms
+             */
+            virtual uint32_t GetDutyBandTimeOff(uint8_t band) {
+                return _dutySchedule.Remaining(band, _dutySchedule.Now());
+            }
+
+            /**
+             * Get the time until a transmit is allowed on a channel
+             * @param channel index of channel
+             * @return ms of time-off remaining for the duty band of the channel and aggregated duty cycle
+             */
+            uint32_t GetChannelTimeOff(uint8_t channel);
+
+            /**
+             * Get the next channel to use to transmit
+             * @return LORA_OK if channel was found
+             * @return LORA_NO_CHANS_ENABLED
+             */
+            virtual uint8_t GetNextChannel();
+
+            /**
+             * Update duty cycle with at given frequency and time on air
+             * @param freq frequency
+             * @param time_on_air_ms tx time on air
+             */
+            virtual void UpdateDutyCycle(uint32_t freq, uint32_t time_on_air_ms);
+
+            /**
+             * Calculate the next time a join request is possible
+             * @param size of join frame
+             * @returns LORA_OK
+             */
+            virtual uint8_t CalculateJoinBackoff(uint8_t size);
+
+            /**
+             * Check if this packet is a beacon and if so extract parameters needed
+             * @param payload of potential beacon
+             * @param size of the packet
+             * @param [out] data extracted from the beacon if this packet was indeed a beacon
+             * @return true if this packet is beacon, false if not
+             */
+            virtual uint8_t DecodeBeacon(const uint8_t* payload,
+                                      size_t size,
+                                      BeaconData_t& data);
+
+            /**
+             * Compute the class B ping slot schedule, dynamic plans do not hop
+             * @param time received in the beacon
+             * @param period of the beacon
+             * @param devAddr of this end-device
+             */
+            virtual void FrequencyHop(uint32_t time, uint32_t period, uint32_t devAddr) {
+                class_b_schedule.Update(GetSettings(), time, period, devAddr);
+            }
+
+            /**
+             * Set the SxRadio rx config provided window, skipped if a continuous window is reopened unchanged
+             * @param window to be opened
+             * @param continuous keep window open
+             * @param wnd_growth factor to increase the rx window by
+             * @param pad_ms time in milliseconds to add to computed window size
+             * @param id multicast session of the window
+             * @return LORA_OK
+             */
+            virtual uint8_t SetRxConfig(uint8_t window,
+                                        bool continuous,
+                                        uint16_t wnd_growth = 1,
+                                        uint16_t pad_ms = 0,
+                                        int8_t id = 0) {
+                RxWindow rxw = GetRxWindow(window, id);
+                RxConfigKey key = { rxw.Frequency, wnd_growth, pad_ms, window, rxw.DatarateIndex, id, continuous };
+
+                if (_rxConfigCache.Current(GetRadio(), key)) {
+                    return LORA_OK;
+                }
+
+                uint8_t ret = ChannelPlan::SetRxConfig(window, continuous, wnd_growth, pad_ms, id);
+                _rxConfigCache.Applied(GetRadio(), key);
+                return ret;
+            }
+
+        protected:
+            /**
+             * Update the cached duty band of a channel, call whenever a channel is added or changed
+             * @param index of channel, -1 for the last channel
+             */
+            void CacheChannelDutyBand(int16_t index) {
+                if (index < 0) {
+                    index = _channels.size() - 1;
+                }
+
+                if (index >= 0 && index < CHANNEL_SELECTOR_MAX_CHANNELS && index < (int16_t)_channels.size()) {
+                    _channelBand[index] = _channels[index].Frequency != 0 ? _dutyBandTable.Find(_channels[index].Frequency) : -1;
+                }
+
+                _channelSelector.Invalidate();
+            }
+
+            /**
+             * Find channels enabled for the current datarate if the mask, datarate or channels changed
+             */
+            void UpdateChannelSelector() {
+                uint8_t start = 0;
+                uint8_t maxChannels = _numChans125k;
+
+                if (GetTxDatarate().Bandwidth == BW_500) {
+                    maxChannels = _numChans500k;
+                    start = _numChans125k;
+                }
+
+                _channelSelector.Update(this, _channelMask, GetSettings()->Session.TxDatarate, start, maxChannels, _channelBand);
+            }
+
+            /**
+             * Clear time-off of duty bands that have expired or are not enforced
+             * @param now current time on the duty cycle schedule
+             */
+            void ExpireDutyBands(uint64_t now) {
+                uint16_t cleared;
+
+                if (GetSettings()->Test.DisableDutyCycle == lora::ON || (Region::LBT_SKIPS_DUTY_CYCLE && _LBT_TimeUs > 0)) {
+                    cleared = _dutySchedule.Pending() & ~(1 << DUTY_CYCLE_AGGREGATED);
+                    for (uint8_t i = 0; i < DUTY_CYCLE_SCHEDULE_BANDS; i++) {
+                        _dutySchedule.Set(i, 0);
+                    }
+                } else {
+                    cleared = _dutySchedule.Expire(now) & ~(1 << DUTY_CYCLE_AGGREGATED);
+                }
+
+                for (uint8_t i = 0; cleared != 0; i++, cleared >>= 1) {
+                    if ((cleared & 1) && i < _dutyBands.size()) {
+                        _dutyBands[i].TimeOffEnd = 0;
+                    }
+                }
+            }
+
+            /**
+             * Time until the duty cycle allows the next transmit on any enabled channel
+             * @return ms of time-off remaining
+             */
+            uint32_t DutyCycleTimeOff();
+
+            /**
+             * Milliseconds elapsed on the duty cycle timer
+             */
+            uint32_t DutyCycleElapsed() {
+                return std::chrono::duration_cast<std::chrono::milliseconds>(_dutyCycleTimer.elapsed_time()).count();
+            }
+
+            /**
+             * Indicates duty cycle is not enforced for transmissions at the current power
+             */
+            bool DutyCycleExempt(uint32_t freq) {
+                if ((GetSettings()->Session.TxPower + GetSettings()->Network.AntennaGain) > 7) {
+                    return false;
+                }
+
+                if (Region::VAR_FREQ_RULE == VAR_FREQ_FIXED) {
+                    return freq > Region::VAR_FREQ_MIN && freq < Region::VAR_FREQ_MAX;
+                } else if (Region::VAR_FREQ_RULE == VAR_FREQ_PLAN) {
+                    return freq > _minFrequency && freq < _maxFrequency;
+                }
+
+                return false;
+            }
+
+            ChannelSelector _channelSelector;                           //!< Channels eligible for transmit at the current datarate
+            ClearChannelSearch _clearChannelSearch;                     //!< Listen before talk over the available channels
+            RxConfigCache _rxConfigCache;                               //!< Last continuous receive window configured
+            DutyBandTable _dutyBandTable;                               //!< Sorted duty band intervals for frequency lookup
+            DutyCycleSchedule _dutySchedule;                            //!< Absolute end of time-off for each duty band
+            int8_t _channelBand[CHANNEL_SELECTOR_MAX_CHANNELS];         //!< Duty band index of each channel
+    };
+
+    template <typename Region>
+    uint8_t ChannelPlan_Dynamic<Region>::GetNextChannel()
+    {
+        if (GetSettings()->Session.AggregatedTimeOffEnd != 0) {
+            return LORA_AGGREGATED_DUTY_CYCLE;
+        }
+
+        uint64_t now = _dutySchedule.Now();
+
+        ExpireDutyBands(now);
+
+        if (P2PEnabled() || GetSettings()->Network.TxFrequency != 0) {
+            logDebug("Using frequency %d", GetSettings()->Network.TxFrequency);
+
+            int8_t band = GetDutyBand(GetSettings()->Network.TxFrequency);
+            logDebug("band: %d freq: %d", band, GetSettings()->Network.TxFrequency);
+            if (band != -1 && _dutySchedule.Remaining(band, now) != 0) {
+                return LORA_NO_CHANS_ENABLED;
+            }
+
+            GetRadio()->SetChannel(GetSettings()->Network.TxFrequency);
+            return LORA_OK;
+        }
+
+        UpdateChannelSelector();
+        uint8_t nbEnabledChannels = _channelSelector.Available(_dutySchedule.Pending());
+        nbEnabledChannels = _channelSelector.Exclude(channel_quality.Excluded());
+
+        logTrace("Number of available channels: %d", nbEnabledChannels);
+
+        uint32_t freq = 0;
+
+        if (nbEnabledChannels == 0) {
+            return LORA_NO_CHANS_ENABLED;
+        }
+
+        if (GetSettings()->Network.CADEnabled) {
+            // Listen before talk, plans with LBT settings use their sense time and threshold
+            int16_t thres = _LBT_TimeUs > 0 ? _LBT_Threshold : DEFAULT_FREE_CHAN_RSSI_THRESHOLD;
+            uint32_t sense_us = _LBT_TimeUs > 0 ? _LBT_TimeUs : CLEAR_CHANNEL_SENSE_US;
+
+            if (!_clearChannelSearch.Find(this, GetRadio(), _channelSelector, nbEnabledChannels, thres, sense_us, _txChannel)) {
+                return LORA_NO_FREE_CHAN;
+            }
+
+            freq = GetChannel(_txChannel).Frequency;
+        } else {
+            uint8_t j = rand_r(0, nbEnabledChannels - 1);
+            _txChannel = _channelSelector.Select(j);
+            freq = GetChannel(_txChannel).Frequency;
+        }
+
+        assert(freq != 0);
+
+        channel_quality.Sent(_txChannel);
+
+        logDebug("Using channel %d : %d", _txChannel, freq);
+        GetRadio()->SetChannel(freq);
+
+        return LORA_OK;
+    }
+
+    template <typename Region>
+    uint32_t ChannelPlan_Dynamic<Region>::GetChannelTimeOff(uint8_t channel) {
+        uint64_t now = _dutySchedule.Now();
+        uint32_t time_off = 0;
+
+        if (GetSettings()->Test.DisableDutyCycle == lora::OFF && !(Region::LBT_SKIPS_DUTY_CYCLE && _LBT_TimeUs > 0)) {
+            int8_t band = GetChannelDutyBand(channel);
+            if (band != -1) {
+                time_off = _dutySchedule.Remaining(band, now);
+            }
+        }
+
+        if (GetSettings()->Session.AggregatedTimeOffEnd != 0) {
+            time_off = std::max < uint32_t > (time_off, _dutySchedule.Remaining(DUTY_CYCLE_AGGREGATED, now));
+        }
+
+        return time_off;
+    }
+
+    template <typename Region>
+    uint32_t ChannelPlan_Dynamic<Region>::DutyCycleTimeOff() {
+        uint64_t now = _dutySchedule.Now();
+        uint32_t min = 0;
+
+        if (GetSettings()->Test.DisableDutyCycle == lora::OFF && !(Region::LBT_SKIPS_DUTY_CYCLE && _LBT_TimeUs > 0)) {
+            if (P2PEnabled() || GetSettings()->Network.TxFrequency != 0) {
+                int8_t band = GetDutyBand(GetSettings()->Network.TxFrequency);
+                if (band != -1) {
+                    min = _dutySchedule.Remaining(band, now);
+                }
+            } else {
+                // Only bands holding an enabled channel for the datarate limit the next transmit
+                UpdateChannelSelector();
+                uint16_t bands = _channelSelector.EligibleBands();
+
+                min = UINT_MAX;
+
+                for (uint8_t i = 0; bands != 0 && min != 0; i++, bands >>= 1) {
+                    if (bands & 1) {
+                        min = std::min < uint32_t > (min, _dutySchedule.Remaining(i, now));
+                    }
+                }
+
+                if (min == UINT_MAX)
+                    min = 0;
+            }
+        }
+
+        if (GetSettings()->Session.AggregatedTimeOffEnd != 0) {
+            min = std::max < uint32_t > (min, _dutySchedule.Remaining(DUTY_CYCLE_AGGREGATED, now));
+        }
+
+        return min;
+    }
+
+    template <typename Region>
+    void ChannelPlan_Dynamic<Region>::UpdateDutyCycle(uint32_t freq, uint32_t time_on_air_ms) {
+        _dutyCycleTimer.start();
+
+        uint32_t elapsed = DutyCycleElapsed();
+        uint64_t now = _dutySchedule.Now();
+
+        _dutySchedule.Expire(now);
+
+        if (GetSettings()->Session.MaxDutyCycle > 0 && GetSettings()->Session.MaxDutyCycle <= 15) {
+            uint32_t time_off_air = time_on_air_ms * GetSettings()->Session.AggregateDutyCycle;
+            GetSettings()->Session.AggregatedTimeOffEnd = elapsed + time_off_air;
+            _dutySchedule.Set(DUTY_CYCLE_AGGREGATED, now + time_off_air);
+            logDebug("Updated Aggregate DCycle Time-off: %lu DC: %f", GetSettings()->Session.AggregatedTimeOffEnd, 1 / float(GetSettings()->Session.AggregateDutyCycle));
+        } else {
+            GetSettings()->Session.AggregatedTimeOffEnd = 0;
+            _dutySchedule.Set(DUTY_CYCLE_AGGREGATED, 0);
+        }
+
+        // Every band containing the frequency is charged, bands may share an edge
+        uint8_t bands = _dutyBandTable.FindAll(freq);
+
+        for (uint8_t band = 0; band < _dutyBands.size() && bands != 0; band++) {
+            if (!(bands & (1 << band))) {
+                continue;
+            }
+            bands &= ~(1 << band);
+
+            logDebug("update TOE: freq: %d i:%d toa: %d DC:%d", freq, band, time_on_air_ms, _dutyBands[band].DutyCycle);
+
+            if (DutyCycleExempt(freq)) {
+                _dutySchedule.Set(band, 0);
+            } else {
+                _dutySchedule.Set(band, now + time_on_air_ms * _dutyBands[band].DutyCycle);
+            }
+        }
+
+        // Duty cycle timer restarts from zero, keep band time-off relative to it
+        for (size_t i = 0; i < _dutyBands.size(); i++) {
+            _dutyBands[i].TimeOffEnd = _dutySchedule.Remaining(i, now);
+        }
+
+        ResetDutyCycleTimer();
+    }
+
+    template <typename Region>
+    uint8_t ChannelPlan_Dynamic<Region>::CalculateJoinBackoff(uint8_t size) {
+
+        time_t now = time(NULL);
+        uint32_t time_on_max = 0;
+        uint32_t& time_off_max = join_backoff.TimeOffMax;
+        uint32_t rand_time_off = 0;
+
+        if ((time_t)GetSettings()->Session.JoinTimeOffEnd > now) {
+            return LORA_JOIN_BACKOFF;
+        }
+
+        uint32_t secs_since_first_attempt = (now - GetSettings()->Session.JoinFirstAttempt);
+        uint16_t hours_since_first_attempt = secs_since_first_attempt / (60 * 60);
+
+        uint8_t& join_cnt = join_backoff.JoinCount;
+
+        join_cnt = (join_cnt+1) % 8;
+
+        if (GetSettings()->Session.JoinFirstAttempt == 0) {
+            /* 1 % duty-cycle for first hour
+             * 0.1 % next 10 hours
+             * 0.01 % upto 24 hours         */
+            GetSettings()->Session.JoinFirstAttempt = now;
+            GetSettings()->Session.JoinTimeOnAir += GetTimeOnAir(size);
+            GetSettings()->Session.JoinTimeOffEnd = now + (GetTimeOnAir(size) / 10);
+        } else if (join_cnt == 0) {
+            if (hours_since_first_attempt < 1) {
+                time_on_max = 36000;
+                rand_time_off = rand_r(time_off_max - 1, time_off_max + 1);
+                // time off max 1 hour
+                time_off_max = std::min < uint32_t > (time_off_max * 2, 60 * 60);
+
+                if (GetSettings()->Session.JoinTimeOnAir < time_on_max) {
+                    GetSettings()->Session.JoinTimeOnAir += GetTimeOnAir(size);
+                    GetSettings()->Session.JoinTimeOffEnd = now + rand_time_off;
+                } else {
+                    logWarning("Max time-on-air limit met for current join backoff period");
+                    GetSettings()->Session.JoinTimeOffEnd = GetSettings()->Session.JoinFirstAttempt + 60 * 60;
+                }
+            } else if (hours_since_first_attempt < 11) {
+                if (GetSettings()->Session.JoinTimeOnAir < 36000) {
+                    GetSettings()->Session.JoinTimeOnAir = 36000;
+                }
+                time_on_max = 72000;
+                rand_time_off = rand_r(time_off_max - 1, time_off_max + 1);
+                // time off max 1 hour
+                time_off_max = std::min < uint32_t > (time_off_max * 2, 60 * 60);
+
+                if (GetSettings()->Session.JoinTimeOnAir < time_on_max) {
+                    GetSettings()->Session.JoinTimeOnAir += GetTimeOnAir(size);
+                    GetSettings()->Session.JoinTimeOffEnd = now + rand_time_off;
+                } else {
+                    logWarning("Max time-on-air limit met for current join backoff period");
+                    GetSettings()->Session.JoinTimeOffEnd = GetSettings()->Session.JoinFirstAttempt + 11 * 60 * 60;
+                }
+            } else {
+                if (GetSettings()->Session.JoinTimeOnAir < 72000) {
+                    GetSettings()->Session.JoinTimeOnAir = 72000;
+                }
+                uint32_t join_time = Region::JOIN_TIME;
+
+                time_on_max = 80700;
+                time_off_max = 1 * 60 * 60; // 1 hour
+                rand_time_off = rand_r(time_off_max - 1, time_off_max + 1);
+
+                // allow one final join attempt as long as it doesn't start past the max time on air
+                if (GetSettings()->Session.JoinTimeOnAir < time_on_max - join_time) {
+                    GetSettings()->Session.JoinTimeOnAir += GetTimeOnAir(size);
+                    GetSettings()->Session.JoinTimeOffEnd = now + rand_time_off;
+                } else {
+                    logWarning("Max time-on-air limit met for current join backoff period");
+                    // Reset the join time on air and set end of restriction to the next 24 hour period
+                    GetSettings()->Session.JoinTimeOnAir = 72000;
+                    uint16_t days = (now - GetSettings()->Session.JoinFirstAttempt) / (24 * 60 * 60) + 1;
+                    logWarning("days : %d", days);
+                    GetSettings()->Session.JoinTimeOffEnd = GetSettings()->Session.JoinFirstAttempt + ((days * 24) + 11) * 60 * 60;
+                }
+            }
+
+            logWarning("JoinBackoff: %lu seconds  Time On Air: %lu / %lu", GetSettings()->Session.JoinTimeOffEnd - now, GetSettings()->Session.JoinTimeOnAir, time_on_max);
+        } else {
+            GetSettings()->Session.JoinTimeOnAir += GetTimeOnAir(size);
+            GetSettings()->Session.JoinTimeOffEnd = now + (GetTimeOnAir(size) / 10);
+        }
+
+        return LORA_OK;
+    }
+
+    template <typename Region>
+    uint8_t ChannelPlan_Dynamic<Region>::DecodeBeacon(const uint8_t* payload, size_t size, BeaconData_t& data) {
+        // RFU1 | Time | CRC1 | GwSpecific | RFU2 | CRC2
+        const uint8_t* time = payload + Region::BEACON_RFU1;
+        const uint8_t* crc1_field = time + 4;
+        const uint8_t* gw_specific = crc1_field + 2;
+        const uint8_t* crc2_field = gw_specific + 7 + Region::BEACON_RFU2;
+        uint16_t crc1, crc1_rx, crc2, crc2_rx;
+
+        // First check the size of the packet
+        if (size != BEACON_SIZE)
+            return LORA_BEACON_SIZE;
+
+        // Next we verify CRC1 is correct
+        crc1 = Crc16(payload, Region::BEACON_RFU1 + 4);
+        memcpy((uint8_t*)&crc1_rx, crc1_field, sizeof(uint16_t));
+
+        if (crc1 != crc1_rx)
+            return LORA_BEACON_CRC;
+
+        // Now that we have confirmed this packet is a beacon, parse and complete the output struct
+        memcpy(&data.Time, time, 4);
+        data.InfoDesc = gw_specific[0];
+
+        crc2 = Crc16(gw_specific, 7 + Region::BEACON_RFU2);
+        memcpy((uint8_t*)&crc2_rx, crc2_field, sizeof(uint16_t));
+
+        // Update the GPS fields if we have a gps info descriptor and valid crc
+        if (crc2 == crc2_rx &&
+            (data.InfoDesc == GPS_FIRST_ANTENNA ||
+             data.InfoDesc == GPS_SECOND_ANTENNA ||
+             data.InfoDesc == GPS_THIRD_ANTENNA)) {
+            // Latitude and Longitude 3 bytes in length
+            memcpy(&data.Latitude, &gw_specific[1], 3);
+            memcpy(&data.Longitude, &gw_specific[4], 3);
+        }
+
+        return LORA_OK;
+    }
+
+} // namespace lora
+
+#endif
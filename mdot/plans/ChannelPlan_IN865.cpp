@@ -24,25 +24,29 @@ const uint8_t ChannelPlan_IN865::IN865_TX_POWERS[] = { 30, 28, 26, 24, 22, 20, 1
 const uint8_t ChannelPlan_IN865::IN865_MAX_PAYLOAD_SIZE[] = { 51, 51, 51, 115, 242, 242, 242, 242, 0, 0, 0, 0, 0, 0, 0, 0 };
 const uint8_t ChannelPlan_IN865::IN865_MAX_PAYLOAD_SIZE_REPEATER[] = { 51, 51, 51, 115, 222, 222, 222, 222, 0, 0, 0, 0, 0, 0, 0, 0 };
 
+// Uplink datarates DR0-5
+static constexpr const TimeOnAirRow* IN865_UPLINK_TIME_ON_AIR[] = { &TIME_ON_AIR_SF12_BW125, &TIME_ON_AIR_SF11_BW125, &TIME_ON_AIR_SF10_BW125, &TIME_ON_AIR_SF9_BW125, &TIME_ON_AIR_SF8_BW125, &TIME_ON_AIR_SF7_BW125 };
+const TimeOnAirTable<6> ChannelPlan_IN865::IN865_TIME_ON_AIR(IN865_UPLINK_TIME_ON_AIR);
+
 ChannelPlan_IN865::ChannelPlan_IN865()
 :
-    ChannelPlan(NULL, NULL)
+    ChannelPlan_Dynamic<IN865_Region>(NULL, NULL)
 {
-    _beaconSize = sizeof(BCNPayload);
+    _beaconSize = BEACON_SIZE;
 }
 
 ChannelPlan_IN865::ChannelPlan_IN865(Settings* settings)
 :
-    ChannelPlan(NULL, settings)
+    ChannelPlan_Dynamic<IN865_Region>(NULL, settings)
 {
-    _beaconSize = sizeof(BCNPayload);
+    _beaconSize = BEACON_SIZE;
 }
 
 ChannelPlan_IN865::ChannelPlan_IN865(SxRadio* radio, Settings* settings)
 :
-    ChannelPlan(radio, settings)
+    ChannelPlan_Dynamic<IN865_Region>(radio, settings)
 {
-    _beaconSize = sizeof(BCNPayload);
+    _beaconSize = BEACON_SIZE;
 }
 
 ChannelPlan_IN865::~ChannelPlan_IN865() {
@@ -194,6 +198,8 @@ uint8_t ChannelPlan_IN865::AddChannel(int8_t index, Channel channel) {
         _channels.push_back(channel);
     }
 
+    CacheChannelDutyBand(index);
+
     return LORA_OK;
 }
 
@@ -227,7 +233,7 @@ uint8_t ChannelPlan_IN865::HandleJoinAccept(const uint8_t* buffer, uint8_t size)
 
 uint8_t ChannelPlan_IN865::SetTxConfig() {
 
-    uint8_t band = GetDutyBand(GetChannel(_txChannel).Frequency);
+    uint8_t band = GetChannelDutyBand(_txChannel);
     Datarate txDr = GetDatarate(GetSettings()->Session.TxDatarate);
     int8_t max_pwr = _dutyBands[band].PowerMax;
 
@@ -267,6 +273,8 @@ uint8_t ChannelPlan_IN865::SetTxConfig() {
         crc = true;
     }
 
+    // Transmit settings overwrite the receive window configuration
+    _rxConfigCache.Invalidate();
     GetRadio()->SetTxConfig(modem, pwr, fdev, bw, sf, cr, pl, false, crc, false, 0, iq, 3e3);
 
     logDebug("TX PWR: %u DR: %u SF: %u BW: %u CR: %u PL: %u CRC: %d IQ: %d", pwr, txDr.Index, sf, bw, cr, pl, crc, iq);
@@ -615,51 +623,21 @@ uint8_t ChannelPlan_IN865::ValidateAdrConfiguration() {
     return status;
 }
 
-uint32_t ChannelPlan_IN865::GetTimeOffAir()
+uint32_t ChannelPlan_IN865::GetTimeOnAir(uint8_t bytes, RadioCfg_t cfg)
 {
-    uint32_t min = 0;
-    uint32_t now = _dutyCycleTimer.read_ms();
-
-    if (GetSettings()->Test.DisableDutyCycle == lora::OFF) {
-        min = UINT_MAX;
-        int8_t band = 0;
-
-        if (P2PEnabled()) {
-            int8_t band = GetDutyBand(GetSettings()->Network.TxFrequency);
-            if (_dutyBands[band].TimeOffEnd > now) {
-                min = _dutyBands[band].TimeOffEnd - now;
-            } else {
-                min = 0;
-            }
-        } else {
-            for (size_t i = 0; i < _channels.size(); i++) {
-                if (IsChannelEnabled(i) && GetChannel(i).Frequency != 0 &&
-                    !(GetSettings()->Session.TxDatarate < GetChannel(i).DrRange.Fields.Min ||
-                    GetSettings()->Session.TxDatarate > GetChannel(i).DrRange.Fields.Max)) {
-
-                    band = GetDutyBand(GetChannel(i).Frequency);
-                    if (band != -1) {
-                        // logDebug("band: %d time-off: %d now: %d", band, _dutyBands[band].TimeOffEnd, now);
-                        if (_dutyBands[band].TimeOffEnd > now) {
-                            min = std::min < uint32_t > (min, _dutyBands[band].TimeOffEnd - now);
-                        } else {
-                            min = 0;
-                            break;
-                        }
-                    }
-                }
-            }
-        }
+    uint32_t ms = 0;
 
-        if (min == UINT_MAX)
-            min = 0;
+    if (cfg == TX_RADIO_CFG && IN865_TIME_ON_AIR.Lookup(GetTxDatarate(), bytes, ms)) {
+        return ms;
     }
 
-    if (GetSettings()->Session.AggregatedTimeOffEnd > 0 && GetSettings()->Session.AggregatedTimeOffEnd > now) {
-        min = std::max < uint32_t > (min, GetSettings()->Session.AggregatedTimeOffEnd - now);
-    }
+    return ChannelPlan::GetTimeOnAir(bytes, cfg);
+}
 
-    now = time(NULL);
+uint32_t ChannelPlan_IN865::GetTimeOffAir()
+{
+    uint32_t min = DutyCycleTimeOff();
+    uint32_t now = time(NULL);
     uint32_t join_time = 0;
 
     if (!GetSettings()->Session.Joined && GetSettings()->Session.JoinFirstAttempt != 0 && now < GetSettings()->Session.JoinTimeOffEnd) {
@@ -672,43 +650,6 @@ uint32_t ChannelPlan_IN865::GetTimeOffAir()
 }
 
 
-void ChannelPlan_IN865::UpdateDutyCycle(uint32_t freq, uint32_t time_on_air_ms) {
-
-    _dutyCycleTimer.start();
-
-    if (GetSettings()->Session.MaxDutyCycle > 0 && GetSettings()->Session.MaxDutyCycle <= 15) {
-        GetSettings()->Session.AggregatedTimeOffEnd = _dutyCycleTimer.read_ms() + time_on_air_ms * GetSettings()->Session.AggregateDutyCycle;
-        logDebug("Updated Aggregate DCycle Time-off: %lu DC: %f", GetSettings()->Session.AggregatedTimeOffEnd, 1 / float(GetSettings()->Session.AggregateDutyCycle));
-    } else {
-        GetSettings()->Session.AggregatedTimeOffEnd = 0;
-    }
-
-    uint32_t time_off_air = 0;
-    uint32_t now = _dutyCycleTimer.read_ms();
-
-    for (size_t i = 0; i < _dutyBands.size(); i++) {
-        if (_dutyBands[i].TimeOffEnd < now) {
-            _dutyBands[i].TimeOffEnd = 0;
-        } else {
-            _dutyBands[i].TimeOffEnd -= now;
-        }
-
-        if (freq >= _dutyBands[i].FrequencyMin && freq <= _dutyBands[i].FrequencyMax) {
-            logDebug("update TOE: freq: %d i:%d toa: %d DC:%d", freq, i, time_on_air_ms, _dutyBands[i].DutyCycle);
-
-            if (freq > _minFrequency && freq < _maxFrequency && (GetSettings()->Session.TxPower + GetSettings()->Network.AntennaGain) <= 7) {
-                _dutyBands[i].TimeOffEnd = 0;
-            } else {
-                time_off_air = time_on_air_ms * _dutyBands[i].DutyCycle;
-                _dutyBands[i].TimeOffEnd = time_off_air;
-            }
-        }
-    }
-
-
-    ResetDutyCycleTimer();
-}
-
 std::vector<uint32_t> lora::ChannelPlan_IN865::GetChannels() {
     std::vector < uint32_t > chans;
 
@@ -737,104 +678,9 @@ void lora::ChannelPlan_IN865::EnableDefaultChannels() {
     _channelMask[0] |= 0x0007;
 }
 
-uint8_t ChannelPlan_IN865::GetNextChannel()
-{
-    if (GetSettings()->Session.AggregatedTimeOffEnd != 0) {
-        return LORA_AGGREGATED_DUTY_CYCLE;
-    }
-
-    if (P2PEnabled() || GetSettings()->Network.TxFrequency != 0) {
-        logDebug("Using frequency %d", GetSettings()->Network.TxFrequency);
-
-        if (GetSettings()->Test.DisableDutyCycle != lora::ON) {
-            int8_t band = GetDutyBand(GetSettings()->Network.TxFrequency);
-            logDebug("band: %d freq: %d", band, GetSettings()->Network.TxFrequency);
-            if (band != -1 && _dutyBands[band].TimeOffEnd != 0) {
-                return LORA_NO_CHANS_ENABLED;
-            }
-        }
-
-        GetRadio()->SetChannel(GetSettings()->Network.TxFrequency);
-        return LORA_OK;
-    }
-
-    uint8_t start = 0;
-    uint8_t maxChannels = _numChans125k;
-    uint8_t nbEnabledChannels = 0;
-    uint8_t *enabledChannels = new uint8_t[maxChannels];
-
-    if (GetTxDatarate().Bandwidth == BW_500) {
-        maxChannels = _numChans500k;
-        start = _numChans125k;
-    }
-
-// Search how many channels are enabled
-    DatarateRange range;
-    uint8_t dr_index = GetSettings()->Session.TxDatarate;
-    uint32_t now = _dutyCycleTimer.read_ms();
-
-    for (size_t i = 0; i < _dutyBands.size(); i++) {
-        if (_dutyBands[i].TimeOffEnd < now || GetSettings()->Test.DisableDutyCycle == lora::ON) {
-            _dutyBands[i].TimeOffEnd = 0;
-        }
-    }
-
-    for (uint8_t i = start; i < start + maxChannels; i++) {
-        range = GetChannel(i).DrRange;
-        // logDebug("chan: %d freq: %d range:%02x", i, GetChannel(i).Frequency, range.Value);
-
-        if (IsChannelEnabled(i) && (dr_index >= range.Fields.Min && dr_index <= range.Fields.Max)) {
-            int8_t band = GetDutyBand(GetChannel(i).Frequency);
-            // logDebug("band: %d freq: %d", band, _channels[i].Frequency);
-            if (band != -1 && _dutyBands[band].TimeOffEnd == 0) {
-                enabledChannels[nbEnabledChannels++] = i;
-            }
-        }
-    }
-
-    logTrace("Number of available channels: %d", nbEnabledChannels);
-
-    uint32_t freq = 0;
-    int16_t thres = DEFAULT_FREE_CHAN_RSSI_THRESHOLD;
-
-    if (nbEnabledChannels == 0) {
-        delete [] enabledChannels;
-        return LORA_NO_CHANS_ENABLED;
-    }
-
-    if (GetSettings()->Network.CADEnabled) {
-        // Search for free channel with ms timeout
-        int16_t timeout = 10000;
-        Timer tmr;
-        tmr.start();
-
-        for (uint8_t j = rand_r(0, nbEnabledChannels - 1); tmr.read_ms() < timeout; j++) {
-            freq = GetChannel(enabledChannels[j]).Frequency;
-
-            if (GetRadio()->IsChannelFree(SxRadio::MODEM_LORA, freq, thres)) {
-                _txChannel = enabledChannels[j];
-                break;
-            }
-        }
-    } else {
-        uint8_t j = rand_r(0, nbEnabledChannels - 1);
-        _txChannel = enabledChannels[j];
-        freq = GetChannel(_txChannel).Frequency;
-    }
-
-    assert(freq != 0);
-
-    logDebug("Using channel %d : %d", _txChannel, freq);
-    GetRadio()->SetChannel(freq);
-
-    delete [] enabledChannels;
-    return LORA_OK;
-}
-
-
 uint8_t lora::ChannelPlan_IN865::GetJoinDatarate() {
     uint8_t dr = GetSettings()->Session.TxDatarate;
-    static uint8_t cnt = 1;
+    uint8_t& cnt = join_backoff.DatarateCount;
 
     if (GetSettings()->Test.DisableRandomJoinDatarate == lora::OFF) {
         if ((cnt++ % 20) == 0) {
@@ -855,95 +701,6 @@ uint8_t lora::ChannelPlan_IN865::GetJoinDatarate() {
     return dr;
 }
 
-uint8_t ChannelPlan_IN865::CalculateJoinBackoff(uint8_t size) {
-
-    time_t now = time(NULL);
-    uint32_t time_on_max = 0;
-    static uint32_t time_off_max = 15;
-    uint32_t rand_time_off = 0;
-
-    // TODO: calc time-off-max based on RTC time from JoinFirstAttempt, time-off-max is lost over sleep
-
-    if ((time_t)GetSettings()->Session.JoinTimeOffEnd > now) {
-        return LORA_JOIN_BACKOFF;
-    }
-
-    uint32_t secs_since_first_attempt = (now - GetSettings()->Session.JoinFirstAttempt);
-    uint16_t hours_since_first_attempt = secs_since_first_attempt / (60 * 60);
-
-    static uint8_t join_cnt = 0;
-
-    join_cnt = (join_cnt+1) % 8;
-
-    if (GetSettings()->Session.JoinFirstAttempt == 0) {
-        /* 1 % duty-cycle for first hour
-         * 0.1 % next 10 hours
-         * 0.01 % upto 24 hours         */
-        GetSettings()->Session.JoinFirstAttempt = now;
-        GetSettings()->Session.JoinTimeOnAir += GetTimeOnAir(size);
-        GetSettings()->Session.JoinTimeOffEnd = now + (GetTimeOnAir(size) / 10);
-    } else if (join_cnt == 0) {
-        if (hours_since_first_attempt < 1) {
-            time_on_max = 36000;
-            rand_time_off = rand_r(time_off_max - 1, time_off_max + 1);
-            // time off max 1 hour
-            time_off_max = std::min < uint32_t > (time_off_max * 2, 60 * 60);
-
-            if (GetSettings()->Session.JoinTimeOnAir < time_on_max) {
-                GetSettings()->Session.JoinTimeOnAir += GetTimeOnAir(size);
-                GetSettings()->Session.JoinTimeOffEnd = now + rand_time_off;
-            } else {
-                logWarning("Max time-on-air limit met for current join backoff period");
-                GetSettings()->Session.JoinTimeOffEnd = GetSettings()->Session.JoinFirstAttempt + 60 * 60;
-            }
-        } else if (hours_since_first_attempt < 11) {
-            if (GetSettings()->Session.JoinTimeOnAir < 36000) {
-                GetSettings()->Session.JoinTimeOnAir = 36000;
-            }
-            time_on_max = 72000;
-            rand_time_off = rand_r(time_off_max - 1, time_off_max + 1);
-            // time off max 1 hour
-            time_off_max = std::min < uint32_t > (time_off_max * 2, 60 * 60);
-
-            if (GetSettings()->Session.JoinTimeOnAir < time_on_max) {
-                GetSettings()->Session.JoinTimeOnAir += GetTimeOnAir(size);
-                GetSettings()->Session.JoinTimeOffEnd = now + rand_time_off;
-            } else {
-                logWarning("Max time-on-air limit met for current join backoff period");
-                GetSettings()->Session.JoinTimeOffEnd = GetSettings()->Session.JoinFirstAttempt + 11 * 60 * 60;
-            }
-        } else {
-            if (GetSettings()->Session.JoinTimeOnAir < 72000) {
-                GetSettings()->Session.JoinTimeOnAir = 72000;
-            }
-            uint32_t join_time = 2500;
-
-            time_on_max = 80700;
-            time_off_max = 1 * 60 * 60; // 1 hour
-            rand_time_off = rand_r(time_off_max - 1, time_off_max + 1);
-
-            if (GetSettings()->Session.JoinTimeOnAir < time_on_max - join_time) {
-                GetSettings()->Session.JoinTimeOnAir += GetTimeOnAir(size);
-                GetSettings()->Session.JoinTimeOffEnd = now + rand_time_off;
-            } else {
-                logWarning("Max time-on-air limit met for current join backoff period");
-                // Reset the join time on air and set end of restriction to the next 24 hour period
-                GetSettings()->Session.JoinTimeOnAir = 72000;
-                uint16_t days = (now - GetSettings()->Session.JoinFirstAttempt) / (24 * 60 * 60) + 1;
-                logWarning("days : %d", days);
-                GetSettings()->Session.JoinTimeOffEnd = GetSettings()->Session.JoinFirstAttempt + ((days * 24) + 11) * 60 * 60;
-            }
-        }
-
-        logWarning("JoinBackoff: %lu seconds  Time On Air: %lu / %lu", GetSettings()->Session.JoinTimeOffEnd - now, GetSettings()->Session.JoinTimeOnAir, time_on_max);
-    } else {
-        GetSettings()->Session.JoinTimeOnAir += GetTimeOnAir(size);
-        GetSettings()->Session.JoinTimeOffEnd = now + (GetTimeOnAir(size) / 10);
-    }
-
-    return LORA_OK;
-}
-
 uint8_t ChannelPlan_IN865::HandleMacCommand(uint8_t* payload, uint8_t& index) {
     return LORA_ERROR;
 }
@@ -969,37 +726,3 @@ void ChannelPlan_IN865::DecrementDatarate() {
     GetSettings()->Session.TxDatarate = dr;
 }
 
-uint8_t ChannelPlan_IN865::DecodeBeacon(const uint8_t* payload, size_t size, BeaconData_t& data) {
-    uint16_t crc1, crc1_rx, crc2, crc2_rx;
-    const BCNPayload* beacon = (const BCNPayload*)payload;
-
-    // First check the size of the packet
-    if (size != sizeof(BCNPayload))
-        return LORA_BEACON_SIZE;
-
-    // Next we verify CRC1 is correct
-    crc1 = CRC16(beacon->RFU1, sizeof(beacon->RFU1) + sizeof(beacon->Time));
-    memcpy((uint8_t*)&crc1_rx, beacon->CRC1, sizeof(uint16_t));
-
-    if (crc1 != crc1_rx)
-        return LORA_BEACON_CRC;
-
-    // Now that we have confirmed this packet is a beacon, parse and complete the output struct
-    memcpy(&data.Time, beacon->Time, sizeof(beacon->Time));
-    data.InfoDesc = beacon->GwSpecific[0];
-
-    crc2 = CRC16(beacon->GwSpecific, sizeof(beacon->GwSpecific) + sizeof(beacon->RFU2));
-    memcpy((uint8_t*)&crc2_rx, beacon->CRC2, sizeof(uint16_t));
-
-    // Update the GPS fields if we have a gps info descriptor and valid crc
-    if (crc2 == crc2_rx &&
-        (data.InfoDesc == GPS_FIRST_ANTENNA ||
-         data.InfoDesc == GPS_SECOND_ANTENNA ||
-         data.InfoDesc == GPS_THIRD_ANTENNA)) {
-        // Latitude and Longitude 3 bytes in length
-        memcpy(&data.Latitude, &beacon->GwSpecific[1], 3);
-        memcpy(&data.Longitude, &beacon->GwSpecific[4], 3);
-    }
-
-    return LORA_OK;
-}
@@ -20,6 +20,8 @@
 #include "SxRadio.h"
 #include <vector>
 #include "ChannelPlan.h"
+#include "ChannelPlan_Dynamic.h"
+#include "TimeOnAirTable.h"
 
 namespace lora {
 
@@ -49,7 +51,20 @@ namespace lora {
     const uint32_t RU864_BEACON_FREQ = 869100000U;               //!< Default beacon broadcast frequency
     const uint32_t RU864_PING_SLOT_FREQ = 868900000U;            //!< Default ping slot frequency
 
-    class ChannelPlan_RU864 : public lora::ChannelPlan {
+    /**
+     * RU864 parameters for the shared dynamic channel plan
+     */
+    struct RU864_Region {
+        static const uint32_t JOIN_TIME = 1200;
+        static const uint8_t VAR_FREQ_RULE = VAR_FREQ_NONE;
+        static const uint32_t VAR_FREQ_MIN = 0;
+        static const uint32_t VAR_FREQ_MAX = 0;
+        static const bool LBT_SKIPS_DUTY_CYCLE = true;
+        static const uint8_t BEACON_RFU1 = 2;
+        static const uint8_t BEACON_RFU2 = 0;
+    };
+
+    class ChannelPlan_RU864 : public lora::ChannelPlan_Dynamic<RU864_Region> {
         public:
             /**
              * ChannelPlan constructor
@@ -70,13 +85,6 @@ namespace lora {
              */
             virtual void Init();
 
-            /**
-             * Get the next channel to use to transmit
-             * @return LORA_OK if channel was found
-             * @return LORA_NO_CHANS_ENABLED
-             */
-            virtual uint8_t GetNextChannel();
-
             /**
              * Add a channel to the ChannelPlan
              * @param index of channel, use -1 to add to end
@@ -104,13 +112,6 @@ namespace lora {
              */
             virtual uint8_t GetJoinDatarate();
 
-            /**
-             * Calculate the next time a join request is possible
-             * @param size of join frame
-             * @returns LORA_OK
-             */
-            virtual uint8_t CalculateJoinBackoff(uint8_t size);
-
             /**
              * Get next channel and set the SxRadio tx config with current settings
              * @return LORA_OK
@@ -188,11 +189,12 @@ namespace lora {
             virtual uint8_t ValidateAdrConfiguration();
 
             /**
-             * Update duty cycle with at given frequency and time on air
-             * @param freq frequency
-             * @param time_on_air_ms tx time on air
+             * Get the time on air of a packet, uplink datarates use a precomputed table
+             * @param bytes PHY payload length
+             * @param cfg TX or RX radio settings
+             * @return ms of time on air
              */
-            virtual void UpdateDutyCycle(uint32_t freq, uint32_t time_on_air_ms);
+            virtual uint32_t GetTimeOnAir(uint8_t bytes, RadioCfg_t cfg = TX_RADIO_CFG);
 
             /**
              * Get the time the radio must be off air to comply with regulations
@@ -225,30 +227,12 @@ namespace lora {
              */
             virtual void EnableDefaultChannels();
 
-            /**
-             * Check if this packet is a beacon and if so extract parameters needed
-             * @param payload of potential beacon
-             * @param size of the packet
-             * @param [out] data extracted from the beacon if this packet was indeed a beacon
-             * @return true if this packet is beacon, false if not
-             */
-            virtual uint8_t DecodeBeacon(const uint8_t* payload,
-                                      size_t size,
-                                      BeaconData_t& data);
-
         protected:
 
             static const uint8_t RU864_TX_POWERS[8];                    //!< List of available tx powers
             static const uint8_t RU864_MAX_PAYLOAD_SIZE[];              //!< List of max payload sizes for each datarate
+            static const TimeOnAirTable<7> RU864_TIME_ON_AIR;           //!< Uplink time on air for each datarate and payload length
             static const uint8_t RU864_MAX_PAYLOAD_SIZE_REPEATER[];     //!< List of repeater compatible max payload sizes for each datarate
-
-            typedef struct __attribute__((packed)) {
-                uint8_t RFU[2];
-                uint8_t Time[4];
-                uint8_t CRC1[2];
-                uint8_t GwSpecific[7];
-                uint8_t CRC2[2];
-            } BCNPayload;
     };
 }
 
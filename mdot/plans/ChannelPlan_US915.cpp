@@ -24,6 +24,10 @@ const uint8_t ChannelPlan_US915::US915_TX_POWERS[] = { 30, 28, 26, 24, 22, 20, 1
 const uint8_t ChannelPlan_US915::US915_MAX_PAYLOAD_SIZE[] =          { 11, 53, 125, 242, 242, 0, 0, 0, 53, 129, 242, 242, 242, 242, 0, 0 };
 const uint8_t ChannelPlan_US915::US915_MAX_PAYLOAD_SIZE_REPEATER[] = { 11, 53, 125, 222, 222, 0, 0, 0, 33, 109, 222, 222, 222, 222, 0, 0 };
 
+// Uplink datarates DR0-4
+static constexpr const TimeOnAirRow* US915_UPLINK_TIME_ON_AIR[] = { &TIME_ON_AIR_SF10_BW125, &TIME_ON_AIR_SF9_BW125, &TIME_ON_AIR_SF8_BW125, &TIME_ON_AIR_SF7_BW125, &TIME_ON_AIR_SF8_BW500 };
+const TimeOnAirTable<5> ChannelPlan_US915::US915_TIME_ON_AIR(US915_UPLINK_TIME_ON_AIR);
+
 ChannelPlan_US915::ChannelPlan_US915()
 :
   ChannelPlan(NULL, NULL)
@@ -221,6 +225,19 @@ uint8_t ChannelPlan_US915::SetRx2DatarateIndex(uint8_t index) {
     return LORA_OK;
 }
 
+uint8_t ChannelPlan_US915::SetRxConfig(uint8_t window, bool continuous, uint16_t wnd_growth, uint16_t pad_ms, int8_t id) {
+    RxWindow rxw = GetRxWindow(window, id);
+    RxConfigKey key = { rxw.Frequency, wnd_growth, pad_ms, window, rxw.DatarateIndex, id, continuous };
+
+    if (_rxConfigCache.Current(GetRadio(), key)) {
+        return LORA_OK;
+    }
+
+    uint8_t ret = ChannelPlan::SetRxConfig(window, continuous, wnd_growth, pad_ms, id);
+    _rxConfigCache.Applied(GetRadio(), key);
+    return ret;
+}
+
 uint8_t ChannelPlan_US915::SetTxConfig() {
 
     uint8_t band = GetDutyBand(GetChannel(_txChannel).Frequency);
@@ -280,6 +297,8 @@ uint8_t ChannelPlan_US915::SetTxConfig() {
         crc = true;
     }
 
+    // Transmit settings overwrite the receive window configuration
+    _rxConfigCache.Invalidate();
     GetRadio()->SetTxConfig(modem, pwr, fdev, bw, sf, cr, pl, false, crc, false, 0, iq, 3e3);
 
     logDebug("TX PWR: %u DR: %u SF: %u BW: %u CR: %u PL: %u CRC: %d IQ: %d", pwr, txDr.Index, sf, bw, cr, pl, crc, iq);
@@ -299,6 +318,8 @@ uint8_t ChannelPlan_US915::AddChannel(int8_t index, Channel channel) {
         _channels.push_back(channel);
     }
 
+    _channelSelector.Invalidate();
+
     return LORA_OK;
 }
 
@@ -724,6 +745,17 @@ uint8_t ChannelPlan_US915::ValidateAdrConfiguration() {
     return status;
 }
 
+uint32_t ChannelPlan_US915::GetTimeOnAir(uint8_t bytes, RadioCfg_t cfg)
+{
+    uint32_t ms = 0;
+
+    if (cfg == TX_RADIO_CFG && US915_TIME_ON_AIR.Lookup(GetTxDatarate(), bytes, ms)) {
+        return ms;
+    }
+
+    return ChannelPlan::GetTimeOnAir(bytes, cfg);
+}
+
 uint32_t ChannelPlan_US915::GetTimeOffAir()
 {
     uint32_t min = 0;
@@ -823,8 +855,6 @@ uint8_t ChannelPlan_US915::GetNextChannel()
 
     uint8_t start = 0;
     uint8_t maxChannels = _numChans125k;
-    uint8_t nbEnabledChannels = 0;
-    uint8_t *enabledChannels = new uint8_t[maxChannels];
 
     if (GetTxDatarate().Bandwidth == BW_500) {
         maxChannels = _numChans500k;
@@ -832,7 +862,6 @@ uint8_t ChannelPlan_US915::GetNextChannel()
     }
 
 // Search how many channels are enabled
-    DatarateRange range;
     uint8_t dr_index = GetSettings()->Session.TxDatarate;
     uint32_t now = _dutyCycleTimer.read_ms();
 
@@ -842,18 +871,9 @@ uint8_t ChannelPlan_US915::GetNextChannel()
         }
     }
 
-    for (uint8_t i = start; i < start + maxChannels; i++) {
-        range = GetChannel(i).DrRange;
-        // logDebug("chan: %d freq: %d range:%02x", i, GetChannel(i).Frequency, range.Value);
-
-        if (IsChannelEnabled(i) && (dr_index >= range.Fields.Min && dr_index <= range.Fields.Max)) {
-            int8_t band = GetDutyBand(GetChannel(i).Frequency);
-            // logDebug("band: %d freq: %d", band, _channels[i].Frequency);
-            if (band != -1 && _dutyBands[band].TimeOffEnd == 0) {
-                enabledChannels[nbEnabledChannels++] = i;
-            }
-        }
-    }
+    _channelSelector.Update(this, _channelMask, dr_index, start, maxChannels);
+    uint8_t nbEnabledChannels = _channelSelector.Available(_dutyBands);
+    nbEnabledChannels = _channelSelector.Exclude(channel_quality.Excluded());
 
     if (GetTxDatarate().Bandwidth == BW_500) {
         _dutyBands[0].PowerMax = 26;
@@ -868,62 +888,64 @@ uint8_t ChannelPlan_US915::GetNextChannel()
     logTrace("Number of available channels: %d", nbEnabledChannels);
 
     uint32_t freq = 0;
-    int16_t thres = DEFAULT_FREE_CHAN_RSSI_THRESHOLD;
 
     if (nbEnabledChannels == 0) {
-        delete [] enabledChannels;
         return LORA_NO_CHANS_ENABLED;
     }
 
     if (GetSettings()->Network.CADEnabled) {
-        // Search for free channel with ms timeout
-        int16_t timeout = 10000;
-        Timer tmr;
-        tmr.start();
-
-        for (uint8_t j = rand_r(0, nbEnabledChannels - 1); tmr.read_ms() < timeout; j++) {
-            freq = GetChannel(enabledChannels[j]).Frequency;
+        // Listen before talk, plans with LBT settings use their sense time and threshold
+        int16_t thres = _LBT_TimeUs > 0 ? _LBT_Threshold : DEFAULT_FREE_CHAN_RSSI_THRESHOLD;
+        uint32_t sense_us = _LBT_TimeUs > 0 ? _LBT_TimeUs : CLEAR_CHANNEL_SENSE_US;
 
-            if (GetRadio()->IsChannelFree(SxRadio::MODEM_LORA, freq, thres)) {
-                _txChannel = enabledChannels[j];
-                break;
-            }
+        if (!_clearChannelSearch.Find(this, GetRadio(), _channelSelector, nbEnabledChannels, thres, sense_us, _txChannel)) {
+            return LORA_NO_FREE_CHAN;
         }
+
+        freq = GetChannel(_txChannel).Frequency;
     } else {
         uint8_t j = rand_r(0, nbEnabledChannels - 1);
-        _txChannel = enabledChannels[j];
+        _txChannel = _channelSelector.Select(j);
         freq = GetChannel(_txChannel).Frequency;
     }
 
     assert(freq != 0);
 
+    channel_quality.Sent(_txChannel);
+
     logDebug("Using channel %d : %d", _txChannel, freq);
     GetRadio()->SetChannel(freq);
 
-    delete [] enabledChannels;
     return LORA_OK;
 }
 
 uint8_t lora::ChannelPlan_US915::GetJoinDatarate() {
     uint8_t dr = GetSettings()->Session.TxDatarate;
-    static uint8_t fsb = 1;
-    static uint8_t dr4_fsb = 0;
-    static bool altdr = false;
+    uint8_t& fsb = join_backoff.SubBand;
+    uint8_t& dr4_fsb = join_backoff.WideSubBand;
+    bool& altdr = join_backoff.AltDatarate;
 
     if (GetSettings()->Test.DisableRandomJoinDatarate == lora::OFF) {
         if (GetSettings()->Network.FrequencySubBand == 0) {
+            // Sub-bands are searched starting with those that accepted joins before
             if (fsb < 9) {
-                SetFrequencySubBand(fsb);
-                logDebug("JoinDatarate setting frequency sub band to %d",fsb);
-                fsb++;
+                uint8_t sub_band = join_strategy.SubBand(fsb - 1);
+                SetFrequencySubBand(sub_band);
+                logDebug("JoinDatarate setting frequency sub band to %d",sub_band);
                 dr = lora::DR_0;
+                if (fsb == 1 && join_strategy.Datarate() == lora::DR_4) {
+                    dr = lora::DR_4;
+                }
+                fsb++;
+                join_strategy.Attempt(sub_band, dr);
             } else {
                 dr = lora::DR_4;
                 fsb = 1;
                 dr4_fsb++;
                 if(dr4_fsb > 8)
                     dr4_fsb = 1;
-                SetFrequencySubBand(dr4_fsb);
+                SetFrequencySubBand(join_strategy.SubBand(dr4_fsb - 1));
+                join_strategy.Attempt(join_strategy.SubBand(dr4_fsb - 1), dr);
             }
         } else if (altdr && CountBits(_channelMask[4] > 0)) {
             dr = lora::DR_4;
@@ -939,11 +961,9 @@ uint8_t lora::ChannelPlan_US915::CalculateJoinBackoff(uint8_t size) {
 
     time_t now = time(NULL);
     uint32_t time_on_max = 0;
-    static uint32_t time_off_max = 15;
+    uint32_t& time_off_max = join_backoff.TimeOffMax;
     uint32_t rand_time_off = 0;
-    static uint16_t join_cnt = 0;
-
-    // TODO: calc time-off-max based on RTC time from JoinFirstAttempt, time-off-max is lost over sleep
+    uint8_t& join_cnt = join_backoff.JoinCount;
 
     if ((time_t)GetSettings()->Session.JoinTimeOffEnd > now) {
         return LORA_JOIN_BACKOFF;
@@ -1033,7 +1053,7 @@ uint8_t ChannelPlan_US915::DecodeBeacon(const uint8_t* payload, size_t size, Bea
         return LORA_BEACON_SIZE;
 
     // Next we verify CRC1 is correct
-    crc1 = CRC16(beacon->RFU1, sizeof(beacon->RFU1) + sizeof(beacon->Time));
+    crc1 = Crc16(beacon->RFU1, sizeof(beacon->RFU1) + sizeof(beacon->Time));
     memcpy((uint8_t*)&crc1_rx, beacon->CRC1, sizeof(uint16_t));
 
     if (crc1 != crc1_rx)
@@ -1043,7 +1063,7 @@ uint8_t ChannelPlan_US915::DecodeBeacon(const uint8_t* payload, size_t size, Bea
     memcpy(&data.Time, beacon->Time, sizeof(beacon->Time));
     data.InfoDesc = beacon->GwSpecific[0];
 
-    crc2 = CRC16(beacon->GwSpecific, sizeof(beacon->GwSpecific) + sizeof(beacon->RFU2));
+    crc2 = Crc16(beacon->GwSpecific, sizeof(beacon->GwSpecific) + sizeof(beacon->RFU2));
     memcpy((uint8_t*)&crc2_rx, beacon->CRC2, sizeof(uint16_t));
 
     // Update the GPS fields if we have a gps info descriptor and valid crc
@@ -1060,26 +1080,20 @@ uint8_t ChannelPlan_US915::DecodeBeacon(const uint8_t* payload, size_t size, Bea
 }
 
 void ChannelPlan_US915::FrequencyHop(uint32_t time, uint32_t period, uint32_t devAddr) {
-    uint32_t channel;
-    uint32_t freq;
+    class_b_schedule.Update(GetSettings(), time, period, devAddr,
+                            US915_BEACON_FREQ_BASE, US915_BEACON_FREQ_STEP, US915_BEACON_CHANNELS);
 
     if (GetSettings()->Session.BeaconFreqHop) {
-        channel = (time / period) % US915_BEACON_CHANNELS;
-        freq = US915_BEACON_FREQ_BASE + (channel * US915_BEACON_FREQ_STEP);
-        GetSettings()->Session.BeaconFrequency = freq;
+        GetSettings()->Session.BeaconFrequency = class_b_schedule.BeaconFrequency();
     }
 
     if (GetSettings()->Session.PingSlotFreqHop) {
-        channel = (time / period + devAddr) % US915_BEACON_CHANNELS;
-        freq = US915_BEACON_FREQ_BASE + (channel * US915_BEACON_FREQ_STEP);
-        GetSettings()->Session.PingSlotFrequency = freq;
+        GetSettings()->Session.PingSlotFrequency = class_b_schedule.Frequency(CLASS_B_UNICAST);
     }
 
     for (int i = 0; i < lora::MAX_MULTICAST_SESSIONS; ++i) {
         if (GetSettings()->Multicast[i].Address != 0) {
-            channel = (time / period + GetSettings()->Multicast[i].Address) % US915_BEACON_CHANNELS;
-            freq = US915_BEACON_FREQ_BASE + (channel * US915_BEACON_FREQ_STEP);
-            GetSettings()->Multicast[i].Frequency = freq;
+            GetSettings()->Multicast[i].Frequency = class_b_schedule.Frequency(i);
         }
     }
 
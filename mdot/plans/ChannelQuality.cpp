@@ -0,0 +1,137 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#include "ChannelQuality.h"
+#include <string.h>
+
+using namespace lora;
+
+ChannelQuality lora::channel_quality;
+
+ChannelQuality::ChannelQuality()
+{
+    Reset();
+}
+
+void ChannelQuality::Reset() {
+    memset(_stats, 0, sizeof(_stats));
+    memset(_excluded, 0, sizeof(_excluded));
+    _last = -1;
+    _sinceAge = 0;
+}
+
+void ChannelQuality::Sent(uint8_t channel) {
+    if (channel >= CHANNEL_SELECTOR_MAX_CHANNELS) {
+        _last = -1;
+        return;
+    }
+
+    _last = channel;
+
+    if (_stats[channel].Total < UINT16_MAX) {
+        _stats[channel].Total++;
+    }
+
+    if (++_sinceAge >= CHANNEL_QUALITY_AGE_TX) {
+        Age();
+    }
+}
+
+void ChannelQuality::Acked(int16_t rssi, int16_t snr) {
+    if (_last < 0) {
+        return;
+    }
+
+    Stats& s = _stats[_last];
+
+    s.Sent++;
+    s.Acked++;
+    Received(rssi, snr);
+}
+
+void ChannelQuality::Missed() {
+    if (_last < 0) {
+        return;
+    }
+
+    _stats[_last].Sent++;
+    Update(_last);
+    _last = -1;
+}
+
+void ChannelQuality::Received(int16_t rssi, int16_t snr) {
+    if (_last < 0) {
+        return;
+    }
+
+    Stats& s = _stats[_last];
+
+    // Seed with the first sample, then average over about four downlinks
+    if (s.Rssi == 0) {
+        s.Rssi = rssi;
+        s.Snr = snr;
+    } else {
+        s.Rssi = (3 * s.Rssi + rssi) / 4;
+        s.Snr = (3 * s.Snr + snr) / 4;
+    }
+
+    Update(_last);
+    _last = -1;
+}
+
+void ChannelQuality::Update(uint8_t channel) {
+    Stats& s = _stats[channel];
+
+    if (s.Sent >= CHANNEL_QUALITY_MAX_SAMPLES) {
+        s.Sent /= 2;
+        s.Acked /= 2;
+    }
+
+    bool poor = s.Sent >= CHANNEL_QUALITY_MIN_SAMPLES && (uint16_t)s.Acked * 100 < (uint16_t)s.Sent * CHANNEL_QUALITY_MIN_ACK_PCT;
+    bool was = _excluded[channel / 32] & (1UL << (channel % 32));
+
+    if (poor && !was) {
+        _excluded[channel / 32] |= 1UL << (channel % 32);
+        logInfo("Channel %d excluded, %d of %d uplinks acked", channel, s.Acked, s.Sent);
+    } else if (!poor && was) {
+        _excluded[channel / 32] &= ~(1UL << (channel % 32));
+        logInfo("Channel %d restored, %d of %d uplinks acked", channel, s.Acked, s.Sent);
+    }
+}
+
+void ChannelQuality::Age() {
+    _sinceAge = 0;
+
+    for (uint8_t i = 0; i < CHANNEL_SELECTOR_MAX_CHANNELS; i++) {
+        if (_stats[i].Sent != 0) {
+            _stats[i].Sent /= 2;
+            _stats[i].Acked /= 2;
+            Update(i);
+        }
+    }
+}
+
+void ChannelQuality::Log() const {
+    for (uint8_t i = 0; i < CHANNEL_SELECTOR_MAX_CHANNELS; i++) {
+        const Stats& s = _stats[i];
+
+        if (s.Total != 0) {
+            logInfo("Channel %d: tx %u acked %u/%u rssi %d snr %d%s", i, s.Total, s.Acked, s.Sent, s.Rssi, s.Snr,
+                    (_excluded[i / 32] & (1UL << (i % 32))) ? " excluded" : "");
+        }
+    }
+}
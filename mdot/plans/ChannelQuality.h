@@ -0,0 +1,106 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#ifndef __CHANNEL_QUALITY_H__
+#define __CHANNEL_QUALITY_H__
+
+#include "Lora.h"
+#include "ChannelSelector.h"
+
+namespace lora {
+
+    const uint8_t CHANNEL_QUALITY_MIN_SAMPLES = 8;              //!< Confirmed uplinks on a channel before it can be excluded
+    const uint8_t CHANNEL_QUALITY_MIN_ACK_PCT = 50;             //!< Channels acked less often than this are excluded
+    const uint8_t CHANNEL_QUALITY_MAX_SAMPLES = 32;             //!< Counts of a channel are halved when reaching this
+    const uint8_t CHANNEL_QUALITY_AGE_TX = 64;                  //!< Uplinks between halving the counts of all channels
+
+    /**
+     * Link quality of each uplink channel learned from confirmed uplinks.
+     *
+     * Plans report the channel picked for each uplink, the application reports
+     * whether the ack came back.  Channels whose ack ratio falls below
+     * CHANNEL_QUALITY_MIN_ACK_PCT are left out of channel selection.  Counts of
+     * all channels are halved regularly so an excluded channel drops below
+     * CHANNEL_QUALITY_MIN_SAMPLES and gets tried again.
+     */
+    class ChannelQuality {
+        public:
+            ChannelQuality();
+
+            /**
+             * Forget all statistics, call when the channel plan changes or after a join
+             */
+            void Reset();
+
+            /**
+             * Record an uplink
+             * @param channel index of channel used
+             */
+            void Sent(uint8_t channel);
+
+            /**
+             * Record an ack for the last uplink
+             * @param rssi of the downlink
+             * @param snr of the downlink
+             */
+            void Acked(int16_t rssi, int16_t snr);
+
+            /**
+             * Record an ack missed for the last uplink
+             */
+            void Missed();
+
+            /**
+             * Record signal of a downlink following the last uplink
+             * @param rssi of the downlink
+             * @param snr of the downlink
+             */
+            void Received(int16_t rssi, int16_t snr);
+
+            /**
+             * Bitmask of channels with poor link quality
+             */
+            const uint32_t* Excluded() const { return _excluded; }
+
+            /**
+             * Print statistics of channels that have been used
+             */
+            void Log() const;
+
+        private:
+            struct Stats {
+                uint8_t Sent;           //!< Confirmed uplinks
+                uint8_t Acked;          //!< Confirmed uplinks acked
+                int16_t Rssi;           //!< Average downlink RSSI
+                int8_t Snr;             //!< Average downlink SNR
+                uint16_t Total;         //!< All uplinks
+            };
+
+            void Update(uint8_t channel);
+            void Age();
+
+            Stats _stats[CHANNEL_SELECTOR_MAX_CHANNELS];
+            uint32_t _excluded[CHANNEL_SELECTOR_WORDS];
+            int16_t _last;              //!< Channel of the last uplink or -1 once reported
+            uint8_t _sinceAge;
+    };
+
+    extern ChannelQuality channel_quality;
+
+} // namespace lora
+
+#endif
@@ -0,0 +1,175 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#include "ChannelSelector.h"
+#include "ChannelPlan.h"
+#include <string.h>
+
+using namespace lora;
+
+ChannelSelector::ChannelSelector()
+:
+    _valid(false),
+    _maskWords(0),
+    _datarate(0),
+    _start(0),
+    _count(0),
+    _numChannels(0),
+    _numBands(0),
+    _eligibleCount(0),
+    _eligibleBands(0)
+{
+    memset(_mask, 0, sizeof(_mask));
+    memset(_eligible, 0, sizeof(_eligible));
+    memset(_bands, 0, sizeof(_bands));
+    memset(_available, 0, sizeof(_available));
+}
+
+void ChannelSelector::Invalidate() {
+    _valid = false;
+}
+
+uint8_t ChannelSelector::PopCount(uint32_t word) {
+    return __builtin_popcount(word);
+}
+
+void ChannelSelector::Update(ChannelPlan* plan, const std::vector<uint16_t>& mask, uint8_t datarate, uint8_t start, uint8_t count, const int8_t* bands) {
+    uint8_t words = mask.size() < CHANNEL_SELECTOR_MASK_WORDS ? mask.size() : CHANNEL_SELECTOR_MASK_WORDS;
+    uint8_t channels = plan->GetNumberOfChannels();
+    uint8_t num_bands = plan->GetNumDutyBands();
+
+    if (_valid && _datarate == datarate && _start == start && _count == count && _maskWords == words
+        && _numChannels == channels && _numBands == num_bands && memcmp(_mask, &mask[0], words * sizeof(uint16_t)) == 0) {
+        return;
+    }
+
+    _valid = true;
+    _datarate = datarate;
+    _start = start;
+    _count = count;
+    _maskWords = words;
+    _numChannels = channels;
+    _numBands = num_bands;
+    memcpy(_mask, &mask[0], words * sizeof(uint16_t));
+
+    memset(_eligible, 0, sizeof(_eligible));
+    memset(_bands, 0, sizeof(_bands));
+    _eligibleCount = 0;
+    _eligibleBands = 0;
+
+    for (uint16_t i = start; i < start + count && i < CHANNEL_SELECTOR_MAX_CHANNELS; i++) {
+        if (!plan->IsChannelEnabled(i)) {
+            continue;
+        }
+
+        lora::Channel chan = plan->GetChannel(i);
+
+        if (datarate < chan.DrRange.Fields.Min || datarate > chan.DrRange.Fields.Max) {
+            continue;
+        }
+
+        int8_t band = bands ? bands[i] : plan->GetDutyBand(chan.Frequency);
+
+        // Channels outside of all duty bands cannot be used
+        if (band < 0 || band >= CHANNEL_SELECTOR_MAX_BANDS) {
+            continue;
+        }
+
+        _eligible[i / 32] |= 1UL << (i % 32);
+        _bands[band][i / 32] |= 1UL << (i % 32);
+        _eligibleBands |= 1 << band;
+        _eligibleCount++;
+    }
+}
+
+uint8_t ChannelSelector::Available(const std::vector<DutyBand>& bands) {
+    uint16_t off_bands = 0;
+
+    for (size_t b = 0; b < bands.size() && b < CHANNEL_SELECTOR_MAX_BANDS; b++) {
+        if (bands[b].TimeOffEnd != 0) {
+            off_bands |= 1 << b;
+        }
+    }
+
+    return Available(off_bands);
+}
+
+uint8_t ChannelSelector::Available(uint16_t off_bands) {
+    uint8_t available = 0;
+
+    memcpy(_available, _eligible, sizeof(_available));
+
+    // Only bands holding eligible channels need to be removed
+    off_bands &= _eligibleBands;
+
+    for (uint8_t b = 0; off_bands != 0; b++, off_bands >>= 1) {
+        if (off_bands & 1) {
+            for (uint8_t w = 0; w < CHANNEL_SELECTOR_WORDS; w++) {
+                _available[w] &= ~_bands[b][w];
+            }
+        }
+    }
+
+    for (uint8_t w = 0; w < CHANNEL_SELECTOR_WORDS; w++) {
+        available += PopCount(_available[w]);
+    }
+
+    return available;
+}
+
+uint8_t ChannelSelector::Exclude(const uint32_t* excluded) {
+    uint8_t available = 0;
+    uint8_t remaining = 0;
+
+    for (uint8_t w = 0; w < CHANNEL_SELECTOR_WORDS; w++) {
+        available += PopCount(_available[w]);
+        remaining += PopCount(_available[w] & ~excluded[w]);
+    }
+
+    if (remaining == 0 || remaining * 2 < available) {
+        return available;
+    }
+
+    for (uint8_t w = 0; w < CHANNEL_SELECTOR_WORDS; w++) {
+        _available[w] &= ~excluded[w];
+    }
+
+    return remaining;
+}
+
+uint8_t ChannelSelector::Select(uint8_t n) const {
+    uint8_t w = 0;
+
+    // Find the word holding the nth set bit
+    for (; w < CHANNEL_SELECTOR_WORDS; w++) {
+        uint8_t bits = PopCount(_available[w]);
+        if (n < bits) {
+            break;
+        }
+        n -= bits;
+    }
+
+    assert(w < CHANNEL_SELECTOR_WORDS);
+
+    // Clear the lower set bits then take the lowest remaining
+    uint32_t word = _available[w];
+    while (n--) {
+        word &= word - 1;
+    }
+
+    return w * 32 + __builtin_ctz(word);
+}
@@ -0,0 +1,121 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#ifndef __CHANNEL_SELECTOR_H__
+#define __CHANNEL_SELECTOR_H__
+
+#include "Lora.h"
+#include <vector>
+
+namespace lora {
+
+    class ChannelPlan;
+
+    const uint8_t CHANNEL_SELECTOR_MAX_CHANNELS = 96;           //!< Largest channel plan supported, US915 and AU915 use 72
+    const uint8_t CHANNEL_SELECTOR_MAX_BANDS = 8;               //!< Most duty bands tracked
+    const uint8_t CHANNEL_SELECTOR_WORDS = (CHANNEL_SELECTOR_MAX_CHANNELS + 31) / 32;
+    const uint8_t CHANNEL_SELECTOR_MASK_WORDS = (CHANNEL_SELECTOR_MAX_CHANNELS + 15) / 16;
+
+    /**
+     * Set of uplink channels eligible for transmit kept as a bitmask.
+     *
+     * The channels enabled for the current datarate are found once and cached
+     * until the channel mask, datarate or channel list changes.  Each uplink
+     * only removes channels in duty bands that are off and picks a random set
+     * bit, no heap allocation or per channel lookups are needed.
+     */
+    class ChannelSelector {
+        public:
+            ChannelSelector();
+
+            /**
+             * Force eligible channels to be found again, call when a channel or duty band is changed
+             */
+            void Invalidate();
+
+            /**
+             * Find channels enabled for the datarate if anything changed since the last call
+             * @param plan channel plan owning the channels
+             * @param mask current channel mask
+             * @param datarate index of datarate for transmit
+             * @param start first channel index to consider
+             * @param count number of channels to consider
+             * @param bands duty band index of each channel, looked up from the plan if NULL
+             */
+            void Update(ChannelPlan* plan, const std::vector<uint16_t>& mask, uint8_t datarate, uint8_t start, uint8_t count, const int8_t* bands = NULL);
+
+            /**
+             * Remove channels in duty bands with time-off remaining
+             * @param bands duty bands of the channel plan
+             * @return number of channels available for transmit
+             */
+            uint8_t Available(const std::vector<DutyBand>& bands);
+
+            /**
+             * Remove channels in duty bands with time-off remaining
+             * @param off_bands bitmask of duty bands with time-off remaining
+             * @return number of channels available for transmit
+             */
+            uint8_t Available(uint16_t off_bands);
+
+            /**
+             * Remove channels with poor link quality from the available channels, at most half are removed
+             * so traffic stays spread over the channel plan
+             * @param excluded bitmask of channels to avoid
+             * @return number of channels available for transmit
+             */
+            uint8_t Exclude(const uint32_t* excluded);
+
+            /**
+             * Get channel index of the nth available channel
+             * @param n position in available channels, must be less than the count from Available
+             * @return channel index
+             */
+            uint8_t Select(uint8_t n) const;
+
+            /**
+             * Number of channels enabled for the datarate before duty bands are applied
+             */
+            uint8_t Eligible() const { return _eligibleCount; }
+
+            /**
+             * Bitmask of duty bands holding at least one channel enabled for the datarate
+             */
+            uint16_t EligibleBands() const { return _eligibleBands; }
+
+        private:
+            static uint8_t PopCount(uint32_t word);
+
+            bool _valid;
+            uint16_t _mask[CHANNEL_SELECTOR_MASK_WORDS];
+            uint8_t _maskWords;
+            uint8_t _datarate;
+            uint8_t _start;
+            uint8_t _count;
+            uint8_t _numChannels;
+            uint8_t _numBands;
+
+            uint32_t _eligible[CHANNEL_SELECTOR_WORDS];                             //!< Enabled channels in a duty band for the datarate
+            uint32_t _bands[CHANNEL_SELECTOR_MAX_BANDS][CHANNEL_SELECTOR_WORDS];    //!< Eligible channels in each duty band
+            uint32_t _available[CHANNEL_SELECTOR_WORDS];                            //!< Eligible channels with duty bands applied
+            uint8_t _eligibleCount;
+            uint16_t _eligibleBands;
+    };
+
+} // namespace lora
+
+#endif
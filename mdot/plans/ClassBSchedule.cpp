@@ -0,0 +1,196 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#include "ClassBSchedule.h"
+#include "mbedtls/aes.h"
+#include <string.h>
+
+using namespace lora;
+
+ClassBSchedule lora::class_b_schedule;
+
+/**
+ * Pseudo random ping offset source of an address for a beacon
+ * @param aes context keyed with zeros
+ * @param time of the beacon in GPS seconds
+ * @param address of the session
+ * @return first two bytes of the encrypted beacon time and address
+ */
+static uint16_t PingRand(mbedtls_aes_context* aes, uint32_t time, uint32_t address) {
+    uint8_t in[16] = { 0 };
+    uint8_t out[16];
+
+    in[0] = time & 0xFF;
+    in[1] = (time >> 8) & 0xFF;
+    in[2] = (time >> 16) & 0xFF;
+    in[3] = (time >> 24) & 0xFF;
+    in[4] = address & 0xFF;
+    in[5] = (address >> 8) & 0xFF;
+    in[6] = (address >> 16) & 0xFF;
+    in[7] = (address >> 24) & 0xFF;
+
+    mbedtls_aes_crypt_ecb(aes, MBEDTLS_AES_ENCRYPT, in, out);
+
+    return out[0] | (out[1] << 8);
+}
+
+ClassBSchedule::ClassBSchedule() {
+    Reset();
+}
+
+void ClassBSchedule::Reset() {
+    memset(_sessions, 0, sizeof(_sessions));
+    for (uint8_t i = 0; i < CLASS_B_SESSIONS; i++) {
+        _sessions[i].Periodicity = -1;
+    }
+
+    _beaconTime = 0;
+    _period = 0;
+    _beaconFrequency = 0;
+    _freqBase = 0;
+    _freqStep = 0;
+    _channels = 0;
+    _beaconChannel = 0;
+}
+
+bool ClassBSchedule::Update(const Settings* settings, uint32_t time, uint32_t period, uint32_t devAddr,
+                            uint32_t freq_base, uint32_t freq_step, uint8_t channels) {
+    if (period == 0) {
+        return false;
+    }
+
+    // The hop channel of an address only depends on the number of channels
+    bool plan = !Valid() || channels != _channels;
+    bool beacon = plan || time != _beaconTime || period != _period
+                  || freq_base != _freqBase || freq_step != _freqStep;
+
+    if (beacon) {
+        _beaconTime = time;
+        _period = period;
+        _freqBase = freq_base;
+        _freqStep = freq_step;
+        _channels = channels;
+        _beaconChannel = (channels != 0) ? (time / period) % channels : 0;
+    }
+
+    if (channels != 0 && settings->Session.BeaconFreqHop) {
+        _beaconFrequency = freq_base + _beaconChannel * freq_step;
+    } else {
+        _beaconFrequency = settings->Session.BeaconFrequency;
+    }
+
+    // Key is all zeros, only the beacon time and address change the offset
+    static const uint8_t key[16] = { 0 };
+    mbedtls_aes_context aes;
+    mbedtls_aes_init(&aes);
+    mbedtls_aes_setkey_enc(&aes, key, 128);
+
+    bool changed = beacon;
+
+    for (uint8_t i = 0; i < CLASS_B_SESSIONS; i++) {
+        Session& session = _sessions[i];
+        uint32_t address;
+        int8_t periodicity;
+        uint32_t frequency;
+        bool hop;
+
+        if (i == CLASS_B_UNICAST) {
+            address = devAddr;
+            periodicity = settings->Network.PingPeriodicity;
+            frequency = settings->Session.PingSlotFrequency;
+            hop = settings->Session.PingSlotFreqHop;
+        } else {
+            address = settings->Multicast[i].Address;
+            periodicity = settings->Multicast[i].Periodicity;
+            frequency = settings->Multicast[i].Frequency;
+            hop = true;
+        }
+
+        bool scheduled = address != 0 && periodicity >= 0 && periodicity <= CLASS_B_MAX_PERIODICITY;
+
+        if (beacon || address != session.Address || periodicity != session.Periodicity) {
+            if (plan || address != session.Address) {
+                session.Channel = (channels != 0) ? address % channels : 0;
+            }
+
+            if (scheduled) {
+                // Window of 2^12 slots opened 2^(7-periodicity) times
+                session.Period = 1 << (5 + periodicity);
+                session.Offset = PingRand(&aes, time, address) & (session.Period - 1);
+                changed = true;
+            } else if (session.Period != 0) {
+                session.Period = 0;
+                session.Offset = 0;
+                changed = true;
+            }
+
+            session.Address = address;
+            session.Periodicity = periodicity;
+        }
+
+        if (channels != 0 && hop && address != 0) {
+            uint8_t channel = _beaconChannel + session.Channel;
+            if (channel >= channels) {
+                channel -= channels;
+            }
+            session.Frequency = freq_base + channel * freq_step;
+        } else {
+            session.Frequency = frequency;
+        }
+    }
+
+    mbedtls_aes_free(&aes);
+
+    return changed;
+}
+
+int32_t ClassBSchedule::NextSlotMs(uint8_t session, uint32_t ms) const {
+    if (!Valid() || !Active(session)) {
+        return -1;
+    }
+
+    uint32_t first = SlotMs(session, 0);
+    uint32_t step = (uint32_t)_sessions[session].Period * CLASS_B_SLOT_MS;
+    uint32_t slot = first;
+
+    if (ms > first) {
+        slot = first + ((ms - first + step - 1) / step) * step;
+    }
+
+    if (slot >= CLASS_B_BEACON_RESERVED_MS + (uint32_t)CLASS_B_WINDOW_SLOTS * CLASS_B_SLOT_MS) {
+        return -1;
+    }
+
+    return slot;
+}
+
+int32_t ClassBSchedule::NextSlotMs(uint32_t ms, uint8_t& session) const {
+    int32_t next = -1;
+
+    // Unicast first so it keeps a slot it shares with a group
+    for (uint8_t n = 0; n < CLASS_B_SESSIONS; n++) {
+        uint8_t i = (n == 0) ? CLASS_B_UNICAST : n - 1;
+        int32_t slot = NextSlotMs(i, ms);
+
+        if (slot >= 0 && (next < 0 || slot < next)) {
+            next = slot;
+            session = i;
+        }
+    }
+
+    return next;
+}
@@ -0,0 +1,167 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#ifndef __CLASS_B_SCHEDULE_H__
+#define __CLASS_B_SCHEDULE_H__
+
+#include "Lora.h"
+
+namespace lora {
+
+    const uint8_t CLASS_B_UNICAST = MAX_MULTICAST_SESSIONS;             //!< Session index of the unicast ping slots
+    const uint8_t CLASS_B_SESSIONS = MAX_MULTICAST_SESSIONS + 1;        //!< Multicast groups followed by the unicast session
+    const uint16_t CLASS_B_BEACON_RESERVED_MS = 2120;                   //!< Time after beacon start before the first ping slot
+    const uint16_t CLASS_B_SLOT_MS = 30;                                //!< Length of a ping slot
+    const uint16_t CLASS_B_WINDOW_SLOTS = 4096;                         //!< Ping slots in a beacon window
+    const uint8_t CLASS_B_MAX_PERIODICITY = 7;                          //!< Largest periodicity, one ping slot per beacon
+
+    /**
+     * Ping slot times and frequencies of the unicast session and every
+     * multicast group for the current beacon period.
+     *
+     * The ping offset and hop channel of each session are found once when the
+     * beacon is received, so waking for a ping slot only reads the schedule.
+     * The hop channel of an address is kept between beacons and worked out
+     * again only when the address or the number of hop channels changes.
+     */
+    class ClassBSchedule {
+        public:
+            ClassBSchedule();
+
+            /**
+             * Forget the schedule, call when class B is stopped or the session changes
+             */
+            void Reset();
+
+            /**
+             * Compute the schedule for a beacon period
+             * @param settings holding the unicast and multicast sessions
+             * @param time of the beacon in GPS seconds
+             * @param period of the beacons in seconds
+             * @param devAddr of the unicast session
+             * @param freq_base frequency of the first hop channel
+             * @param freq_step between hop channels
+             * @param channels number of hop channels, 0 if the plan does not hop
+             * @return true if any session was recomputed
+             */
+            bool Update(const Settings* settings, uint32_t time, uint32_t period, uint32_t devAddr,
+                        uint32_t freq_base = 0, uint32_t freq_step = 0, uint8_t channels = 0);
+
+            /**
+             * Indicates a beacon period has been scheduled
+             */
+            bool Valid() const { return _period != 0; }
+
+            /**
+             * GPS time in seconds of the scheduled beacon
+             */
+            uint32_t BeaconTime() const { return _beaconTime; }
+
+            /**
+             * Beacon period in seconds
+             */
+            uint32_t BeaconPeriod() const { return _period; }
+
+            /**
+             * Frequency of the scheduled beacon
+             */
+            uint32_t BeaconFrequency() const { return _beaconFrequency; }
+
+            /**
+             * Indicates the session opens ping slots this beacon period
+             * @param session multicast group or CLASS_B_UNICAST
+             */
+            bool Active(uint8_t session) const {
+                return session < CLASS_B_SESSIONS && _sessions[session].Period != 0;
+            }
+
+            /**
+             * Ping slot frequency of a session
+             * @param session multicast group or CLASS_B_UNICAST
+             */
+            uint32_t Frequency(uint8_t session) const {
+                return session < CLASS_B_SESSIONS ? _sessions[session].Frequency : 0;
+            }
+
+            /**
+             * First ping slot of a session in slots from the start of the window
+             * @param session multicast group or CLASS_B_UNICAST
+             */
+            uint16_t PingOffset(uint8_t session) const {
+                return session < CLASS_B_SESSIONS ? _sessions[session].Offset : 0;
+            }
+
+            /**
+             * Slots between ping slots of a session
+             * @param session multicast group or CLASS_B_UNICAST
+             */
+            uint16_t PingPeriod(uint8_t session) const {
+                return session < CLASS_B_SESSIONS ? _sessions[session].Period : 0;
+            }
+
+            /**
+             * Start of a ping slot
+             * @param session multicast group or CLASS_B_UNICAST
+             * @param n ping slot of the session in this beacon period
+             * @return ms from the beacon time
+             */
+            uint32_t SlotMs(uint8_t session, uint8_t n) const {
+                return CLASS_B_BEACON_RESERVED_MS + (_sessions[session].Offset + (uint32_t)n * _sessions[session].Period) * CLASS_B_SLOT_MS;
+            }
+
+            /**
+             * Find the next ping slot of a session
+             * @param session multicast group or CLASS_B_UNICAST
+             * @param ms from the beacon time to search from
+             * @return ms from the beacon time of the slot or -1 if none remain this beacon period
+             */
+            int32_t NextSlotMs(uint8_t session, uint32_t ms) const;
+
+            /**
+             * Find the next ping slot of any session
+             * @param ms from the beacon time to search from
+             * @param [out] session owning the slot, unicast wins when slots fall together
+             * @return ms from the beacon time of the slot or -1 if none remain this beacon period
+             */
+            int32_t NextSlotMs(uint32_t ms, uint8_t& session) const;
+
+        private:
+            struct Session {
+                uint32_t Address;       //!< Address the hop channel and offset were found for
+                uint32_t Frequency;     //!< Ping slot frequency
+                uint16_t Offset;        //!< First ping slot in slots from the window start
+                uint16_t Period;        //!< Slots between ping slots, 0 if inactive
+                int8_t Periodicity;     //!< Periodicity the period was found for
+                uint8_t Channel;        //!< Address modulo the hop channels
+            };
+
+
+            Session _sessions[CLASS_B_SESSIONS];
+            uint32_t _beaconTime;
+            uint32_t _period;
+            uint32_t _beaconFrequency;
+            uint32_t _freqBase;
+            uint32_t _freqStep;
+            uint8_t _channels;
+            uint8_t _beaconChannel;     //!< Beacon number modulo the hop channels
+    };
+
+    extern ClassBSchedule class_b_schedule;
+
+} // namespace lora
+
+#endif
@@ -0,0 +1,83 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#include "ClearChannelSearch.h"
+#include "ChannelPlan.h"
+
+using namespace lora;
+
+ClearChannelSearch::ClearChannelSearch()
+:
+    _probes(0),
+    _senseUs(0),
+    _elapsedMs(0)
+{
+}
+
+bool ClearChannelSearch::Find(ChannelPlan* plan, SxRadio* radio, const ChannelSelector& selector, uint8_t available,
+                              int16_t threshold, uint32_t sense_us, uint8_t& channel) {
+    Timer total;
+    Timer probe;
+    bool found = false;
+
+    _probes = 0;
+    _senseUs = 0;
+
+    if (available > CHANNEL_SELECTOR_MAX_CHANNELS) {
+        available = CHANNEL_SELECTOR_MAX_CHANNELS;
+    }
+
+    total.start();
+
+    for (uint8_t round = 0; round < CLEAR_CHANNEL_MAX_ROUNDS && !found && _senseUs < CLEAR_CHANNEL_BUDGET_US; round++) {
+        if (round > 0) {
+            uint16_t backoff = CLEAR_CHANNEL_BACKOFF_MS << (round - 1);
+            ThisThread::sleep_for(std::chrono::milliseconds(rand_r(backoff, 2 * backoff)));
+        }
+
+        // Shuffle so each channel is sensed once per pass
+        for (uint8_t i = 0; i < available; i++) {
+            uint8_t j = rand_r(0, i);
+            _order[i] = _order[j];
+            _order[j] = i;
+        }
+
+        for (uint8_t i = 0; i < available && _senseUs < CLEAR_CHANNEL_BUDGET_US; i++) {
+            uint8_t chan = selector.Select(_order[i]);
+
+            probe.reset();
+            probe.start();
+            bool free = radio->IsChannelFree(SxRadio::MODEM_LORA, plan->GetChannel(chan).Frequency, threshold, sense_us);
+            probe.stop();
+
+            _probes++;
+            _senseUs += std::chrono::duration_cast<std::chrono::microseconds>(probe.elapsed_time()).count();
+
+            if (free) {
+                channel = chan;
+                found = true;
+                break;
+            }
+        }
+    }
+
+    _elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(total.elapsed_time()).count();
+
+    logDebug("Clear channel search %s: %d probes, %lu us sensing, %lu ms", found ? "found" : "failed", _probes, _senseUs, _elapsedMs);
+
+    return found;
+}
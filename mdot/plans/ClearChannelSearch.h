@@ -0,0 +1,82 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#ifndef __CLEAR_CHANNEL_SEARCH_H__
+#define __CLEAR_CHANNEL_SEARCH_H__
+
+#include "Lora.h"
+#include "SxRadio.h"
+#include "ChannelSelector.h"
+
+namespace lora {
+
+    const uint32_t CLEAR_CHANNEL_BUDGET_US = 100000;            //!< Most time spent sensing for one transmit
+    const uint8_t CLEAR_CHANNEL_MAX_ROUNDS = 3;                 //!< Most passes over the available channels
+    const uint16_t CLEAR_CHANNEL_BACKOFF_MS = 20;               //!< Backoff before the second pass, doubles each pass
+    const uint32_t CLEAR_CHANNEL_SENSE_US = 5000;               //!< Sense time when the plan has no LBT time
+
+    /**
+     * Search for a clear channel before transmit.
+     *
+     * Each pass senses every available channel once in random order.  Between
+     * passes the radio is left asleep for a jittered, doubling backoff.  The
+     * search gives up once the sensing budget or the passes are used up so the
+     * radio is not kept awake on a busy site.
+     */
+    class ClearChannelSearch {
+        public:
+            ClearChannelSearch();
+
+            /**
+             * Find a clear channel
+             * @param plan channel plan owning the channels
+             * @param radio to sense with
+             * @param selector holding the available channels
+             * @param available number of available channels
+             * @param threshold RSSI in dBm above which a channel is busy
+             * @param sense_us time to sense each channel in us
+             * @param [out] channel index of the clear channel
+             * @return true if a clear channel was found
+             */
+            bool Find(ChannelPlan* plan, SxRadio* radio, const ChannelSelector& selector, uint8_t available,
+                      int16_t threshold, uint32_t sense_us, uint8_t& channel);
+
+            /**
+             * Channels sensed during the last search
+             */
+            uint8_t LastProbes() const { return _probes; }
+
+            /**
+             * Time in us spent sensing during the last search
+             */
+            uint32_t LastSenseUs() const { return _senseUs; }
+
+            /**
+             * Time in ms from start to end of the last search including backoff
+             */
+            uint32_t LastElapsedMs() const { return _elapsedMs; }
+
+        private:
+            uint8_t _order[CHANNEL_SELECTOR_MAX_CHANNELS];
+            uint8_t _probes;
+            uint32_t _senseUs;
+            uint32_t _elapsedMs;
+    };
+
+} // namespace lora
+
+#endif
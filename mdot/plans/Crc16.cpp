@@ -0,0 +1,38 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#include "Crc16.h"
+
+using namespace lora;
+
+static constexpr Crc16Table CRC16_TABLE;
+
+static_assert(CRC16_TABLE.Value[1] == CRC16_POLY, "CRC16 table");
+static_assert(CRC16_TABLE.Value[255] == 0x1EF0, "CRC16 table");
+
+// Beacon example from the LoRaWAN class B specification, RFU | Time gives CRC 0x7EA2
+static_assert(Crc16Update(Crc16Update(Crc16Update(Crc16Update(Crc16Update(Crc16Update(0, 0x00), 0x00), 0x00), 0x00), 0x02), 0xCC) == 0x7EA2, "CRC16 beacon");
+
+uint16_t lora::Crc16(const uint8_t* data, size_t size) {
+    uint16_t crc = 0;
+
+    while (size--) {
+        crc = (crc << 8) ^ CRC16_TABLE.Value[(crc >> 8) ^ *data++];
+    }
+
+    return crc;
+}
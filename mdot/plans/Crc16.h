@@ -0,0 +1,68 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#ifndef __CRC16_H__
+#define __CRC16_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace lora {
+
+    const uint16_t CRC16_POLY = 0x1021;                         //!< ITU-T x^16 + x^12 + x^5 + 1
+
+    /**
+     * Add one byte to a 16 bit ITU-T CRC a bit at a time
+     * @param crc current CRC
+     * @param byte data
+     * @return updated CRC
+     */
+    constexpr uint16_t Crc16Update(uint16_t crc, uint8_t byte) {
+        crc ^= (uint16_t)byte << 8;
+
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ CRC16_POLY) : (uint16_t)(crc << 1);
+        }
+
+        return crc;
+    }
+
+    /**
+     * CRC of each possible top byte, built at compile time
+     */
+    struct Crc16Table {
+            uint16_t Value[256];
+
+            constexpr Crc16Table() : Value() {
+                for (uint16_t i = 0; i < 256; i++) {
+                    Value[i] = Crc16Update(0, (uint8_t)i);
+                }
+            }
+    };
+
+    /**
+     * 16 bit ITU-T CRC with zero initial value as used by class B beacons,
+     * one table lookup per byte instead of eight shifts
+     * @param data buffer
+     * @param size number of bytes
+     * @return CRC
+     */
+    uint16_t Crc16(const uint8_t* data, size_t size);
+
+} // namespace lora
+
+#endif
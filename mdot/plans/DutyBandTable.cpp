@@ -0,0 +1,103 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#include "DutyBandTable.h"
+#include <algorithm>
+
+using namespace lora;
+
+DutyBandTable::DutyBandTable()
+:
+    _count(0)
+{
+}
+
+void DutyBandTable::Build(const std::vector<DutyBand>& bands) {
+    uint8_t num_bands = std::min<size_t>(bands.size(), DUTY_BAND_TABLE_MAX_BANDS);
+    uint64_t points[DUTY_BAND_TABLE_MAX_BANDS * 2];
+    uint8_t num_points = 0;
+
+    _count = 0;
+
+    // Every band start and end is an interval boundary, ends are exclusive
+    for (uint8_t i = 0; i < num_bands; i++) {
+        points[num_points++] = bands[i].FrequencyMin;
+        points[num_points++] = (uint64_t)bands[i].FrequencyMax + 1;
+    }
+
+    std::sort(points, points + num_points);
+    num_points = std::unique(points, points + num_points) - points;
+
+    for (uint8_t p = 0; p + 1 < num_points; p++) {
+        int8_t band = -1;
+        uint8_t mask = 0;
+
+        for (uint8_t i = 0; i < num_bands; i++) {
+            if (points[p] >= bands[i].FrequencyMin && points[p] <= bands[i].FrequencyMax) {
+                if (band == -1) {
+                    band = i;
+                }
+                mask |= 1 << i;
+            }
+        }
+
+        if (band == -1) {
+            continue;
+        }
+
+        // Join with the previous interval when it is contiguous and in the same bands
+        if (_count > 0 && _intervals[_count - 1].Bands == mask && (uint64_t)_intervals[_count - 1].Max + 1 == points[p]) {
+            _intervals[_count - 1].Max = points[p + 1] - 1;
+            continue;
+        }
+
+        _intervals[_count].Min = points[p];
+        _intervals[_count].Max = points[p + 1] - 1;
+        _intervals[_count].Band = band;
+        _intervals[_count].Bands = mask;
+        _count++;
+    }
+}
+
+int8_t DutyBandTable::Find(uint32_t freq) const {
+    const Interval* interval = Lookup(freq);
+    return interval != NULL ? interval->Band : -1;
+}
+
+uint8_t DutyBandTable::FindAll(uint32_t freq) const {
+    const Interval* interval = Lookup(freq);
+    return interval != NULL ? interval->Bands : 0;
+}
+
+const DutyBandTable::Interval* DutyBandTable::Lookup(uint32_t freq) const {
+    uint8_t lo = 0;
+    uint8_t hi = _count;
+
+    while (lo < hi) {
+        uint8_t mid = (lo + hi) / 2;
+
+        if (freq < _intervals[mid].Min) {
+            hi = mid;
+        } else if (freq > _intervals[mid].Max) {
+            lo = mid + 1;
+        } else {
+            return &_intervals[mid];
+        }
+    }
+
+    return NULL;
+}
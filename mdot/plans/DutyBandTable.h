@@ -0,0 +1,76 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#ifndef __DUTY_BAND_TABLE_H__
+#define __DUTY_BAND_TABLE_H__
+
+#include "Lora.h"
+#include <vector>
+
+namespace lora {
+
+    const uint8_t DUTY_BAND_TABLE_MAX_BANDS = 8;                //!< Most duty bands in a table
+
+    /**
+     * Sorted, non-overlapping frequency intervals labelled with duty band index.
+     *
+     * Built from the duty band list whenever it changes.  Where bands overlap the
+     * lowest band index wins, matching a linear search of the band list, so a
+     * lookup is a binary search instead of a scan of every band.  Each interval
+     * also keeps the mask of every band containing it for charging time-off.
+     */
+    class DutyBandTable {
+        public:
+            DutyBandTable();
+
+            /**
+             * Rebuild intervals from the band list
+             * @param bands duty bands of the channel plan
+             */
+            void Build(const std::vector<DutyBand>& bands);
+
+            /**
+             * Find the duty band of a frequency
+             * @param freq frequency in Hz
+             * @return band index or -1 if no band contains the frequency
+             */
+            int8_t Find(uint32_t freq) const;
+
+            /**
+             * Find every duty band containing a frequency
+             * @param freq frequency in Hz
+             * @return bitmask of band indexes, 0 if no band contains the frequency
+             */
+            uint8_t FindAll(uint32_t freq) const;
+
+        private:
+            struct Interval {
+                uint32_t Min;           //!< First frequency of the interval
+                uint32_t Max;           //!< Last frequency of the interval
+                int8_t Band;            //!< Index of the duty band
+                uint8_t Bands;          //!< Bitmask of all duty bands containing the interval
+            };
+
+            const Interval* Lookup(uint32_t freq) const;
+
+            Interval _intervals[DUTY_BAND_TABLE_MAX_BANDS * 2];
+            uint8_t _count;
+    };
+
+} // namespace lora
+
+#endif
@@ -0,0 +1,105 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#include "DutyCycleSchedule.h"
+
+using namespace lora;
+
+DutyCycleSchedule::DutyCycleSchedule()
+{
+    Clear();
+    _clock.start();
+}
+
+uint64_t DutyCycleSchedule::Now() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(_clock.elapsed_time()).count();
+}
+
+void DutyCycleSchedule::Clear() {
+    for (uint8_t i = 0; i <= DUTY_CYCLE_SCHEDULE_BANDS; i++) {
+        _expiry[i] = 0;
+    }
+
+    _earliest = 0;
+    _pending = 0;
+}
+
+void DutyCycleSchedule::Set(uint8_t slot, uint64_t expiry) {
+    if (slot > DUTY_CYCLE_SCHEDULE_BANDS) {
+        return;
+    }
+
+    bool was_earliest = _expiry[slot] != 0 && _expiry[slot] == _earliest;
+
+    _expiry[slot] = expiry;
+
+    if (expiry != 0) {
+        _pending |= (1 << slot);
+
+        if (_earliest == 0 || expiry < _earliest) {
+            _earliest = expiry;
+            return;
+        }
+    } else {
+        _pending &= ~(1 << slot);
+    }
+
+    // Only a scan when the earliest slot moved later
+    if (was_earliest) {
+        FindEarliest();
+    }
+}
+
+uint64_t DutyCycleSchedule::Expiry(uint8_t slot) const {
+    return slot <= DUTY_CYCLE_SCHEDULE_BANDS ? _expiry[slot] : 0;
+}
+
+uint32_t DutyCycleSchedule::Remaining(uint8_t slot, uint64_t now) const {
+    uint64_t expiry = Expiry(slot);
+    return expiry > now ? (uint32_t)(expiry - now) : 0;
+}
+
+uint16_t DutyCycleSchedule::Expire(uint64_t now) {
+    uint16_t cleared = 0;
+
+    // Nothing to do until the earliest expiry passes
+    if (_earliest == 0 || _earliest > now) {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i <= DUTY_CYCLE_SCHEDULE_BANDS; i++) {
+        if ((_pending & (1 << i)) && _expiry[i] <= now) {
+            _expiry[i] = 0;
+            _pending &= ~(1 << i);
+            cleared |= (1 << i);
+        }
+    }
+
+    FindEarliest();
+
+    return cleared;
+}
+
+void DutyCycleSchedule::FindEarliest() {
+    _earliest = 0;
+
+    for (uint8_t i = 0; i <= DUTY_CYCLE_SCHEDULE_BANDS; i++) {
+        if ((_pending & (1 << i)) && (_earliest == 0 || _expiry[i] < _earliest)) {
+            _earliest = _expiry[i];
+        }
+    }
+}
@@ -0,0 +1,103 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#ifndef __DUTY_CYCLE_SCHEDULE_H__
+#define __DUTY_CYCLE_SCHEDULE_H__
+
+#include "mbed.h"
+#include "Lora.h"
+
+namespace lora {
+
+    const uint8_t DUTY_CYCLE_SCHEDULE_BANDS = 8;                //!< Most duty bands tracked
+    const uint8_t DUTY_CYCLE_AGGREGATED = DUTY_CYCLE_SCHEDULE_BANDS;    //!< Slot for the aggregated duty cycle
+
+    /**
+     * Absolute time-off expiry for each duty band and the aggregated duty cycle.
+     *
+     * Expiries are kept on a free running millisecond clock so they never need
+     * to be rebased after a transmission, and the earliest pending expiry is
+     * kept up to date as slots change so it can be read without a scan.  Time-off
+     * is only ever looked up by band index, a full timer wheel is not needed for
+     * the handful of bands a plan defines.
+     */
+    class DutyCycleSchedule {
+        public:
+            DutyCycleSchedule();
+
+            /**
+             * Current time in ms on the free running schedule clock
+             */
+            uint64_t Now();
+
+            /**
+             * Clear all time-off
+             */
+            void Clear();
+
+            /**
+             * Set the end of time-off for a slot
+             * @param slot duty band index or DUTY_CYCLE_AGGREGATED
+             * @param expiry absolute time in ms time-off ends, 0 for none
+             */
+            void Set(uint8_t slot, uint64_t expiry);
+
+            /**
+             * Get the end of time-off for a slot
+             * @param slot duty band index or DUTY_CYCLE_AGGREGATED
+             * @return absolute time in ms or 0 if none
+             */
+            uint64_t Expiry(uint8_t slot) const;
+
+            /**
+             * Time-off remaining for a slot
+             * @param slot duty band index or DUTY_CYCLE_AGGREGATED
+             * @param now current time in ms
+             * @return ms remaining, 0 if expired
+             */
+            uint32_t Remaining(uint8_t slot, uint64_t now) const;
+
+            /**
+             * Clear slots whose time-off has ended
+             * @param now current time in ms
+             * @return bitmask of slots cleared
+             */
+            uint16_t Expire(uint64_t now);
+
+            /**
+             * Earliest pending expiry of any slot
+             * @return absolute time in ms or 0 if no time-off is pending
+             */
+            uint64_t Earliest() const { return _earliest; }
+
+            /**
+             * Bitmask of slots with time-off pending, some may have expired since the last call to Expire
+             */
+            uint16_t Pending() const { return _pending; }
+
+        private:
+            void FindEarliest();
+
+            LowPowerTimer _clock;               //!< Keeps counting through sleep
+            uint64_t _expiry[DUTY_CYCLE_SCHEDULE_BANDS + 1];
+            uint64_t _earliest;
+            uint16_t _pending;                  //!< Bitmask of slots with time-off
+    };
+
+} // namespace lora
+
+#endif
@@ -0,0 +1,57 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#include "JoinBackoffState.h"
+
+using namespace lora;
+
+JoinBackoffState lora::join_backoff;
+
+JoinBackoffState::JoinBackoffState()
+{
+    Reset();
+}
+
+void JoinBackoffState::Reset() {
+    TimeOffMax = 15;
+    JoinCount = 0;
+    DatarateCount = 1;
+    SubBand = 1;
+    WideSubBand = 0;
+    AltDatarate = false;
+}
+
+void JoinBackoffState::Pack(uint32_t words[JOIN_BACKOFF_STATE_WORDS]) const {
+    // time-off max is capped at one hour and fits in 16 bits
+    words[0] = (TimeOffMax & 0xFFFF) | ((uint32_t)JoinCount << 16) | ((uint32_t)DatarateCount << 24);
+    words[1] = SubBand | ((uint32_t)WideSubBand << 8) | ((uint32_t)AltDatarate << 16) | ((uint32_t)JOIN_BACKOFF_STATE_MAGIC << 24);
+}
+
+bool JoinBackoffState::Unpack(const uint32_t words[JOIN_BACKOFF_STATE_WORDS]) {
+    if ((words[1] >> 24) != JOIN_BACKOFF_STATE_MAGIC) {
+        return false;
+    }
+
+    TimeOffMax = words[0] & 0xFFFF;
+    JoinCount = (words[0] >> 16) & 0xFF;
+    DatarateCount = (words[0] >> 24) & 0xFF;
+    SubBand = words[1] & 0xFF;
+    WideSubBand = (words[1] >> 8) & 0xFF;
+    AltDatarate = (words[1] >> 16) & 0x01;
+
+    return true;
+}
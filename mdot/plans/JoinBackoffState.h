@@ -0,0 +1,68 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#ifndef __JOIN_BACKOFF_STATE_H__
+#define __JOIN_BACKOFF_STATE_H__
+
+#include <stdint.h>
+
+namespace lora {
+
+    const uint8_t JOIN_BACKOFF_STATE_WORDS = 2;                 //!< 32-bit words needed to save the state
+    const uint8_t JOIN_BACKOFF_STATE_MAGIC = 0x4A;              //!< Marks saved state as valid
+
+    /**
+     * Join backoff and join datarate progress carried between join attempts.
+     *
+     * Plans keep this here instead of in function statics so the application
+     * can save it before deep sleep, which restarts the processor, and restore
+     * it on wake instead of starting the backoff schedule over.
+     */
+    struct JoinBackoffState {
+            uint32_t TimeOffMax;        //!< Ceiling of random join time-off in seconds
+            uint8_t JoinCount;          //!< Join attempts since the last backoff step
+            uint8_t DatarateCount;      //!< Position in the random join datarate sequence
+            uint8_t SubBand;            //!< Next sub-band to join on when none is configured
+            uint8_t WideSubBand;        //!< Sub-band of the last wide channel join
+            bool AltDatarate;           //!< Join on the alternate datarate next
+
+            JoinBackoffState();
+
+            /**
+             * Restart the join backoff schedule
+             */
+            void Reset();
+
+            /**
+             * Pack state for saving in backup registers
+             * @param [out] words packed state
+             */
+            void Pack(uint32_t words[JOIN_BACKOFF_STATE_WORDS]) const;
+
+            /**
+             * Restore state saved with Pack
+             * @param words packed state
+             * @return true if the words held saved state
+             */
+            bool Unpack(const uint32_t words[JOIN_BACKOFF_STATE_WORDS]);
+    };
+
+    extern JoinBackoffState join_backoff;
+
+} // namespace lora
+
+#endif
@@ -0,0 +1,106 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#include "JoinStrategy.h"
+#include <string.h>
+
+using namespace lora;
+
+JoinStrategy lora::join_strategy;
+
+JoinStrategy::JoinStrategy()
+{
+    Reset();
+}
+
+void JoinStrategy::Reset() {
+    memset(&_history, 0, sizeof(_history));
+    _history.Magic = JOIN_STRATEGY_MAGIC;
+    _history.Datarate = JOIN_STRATEGY_NO_DATARATE;
+    _attemptSubBand = 0;
+    _attemptDatarate = JOIN_STRATEGY_NO_DATARATE;
+    Sort();
+}
+
+uint8_t JoinStrategy::SubBand(uint8_t n) const {
+    return _order[n % JOIN_STRATEGY_SUB_BANDS];
+}
+
+void JoinStrategy::Attempt(uint8_t sub_band, uint8_t datarate) {
+    _attemptSubBand = sub_band;
+    _attemptDatarate = datarate;
+}
+
+bool JoinStrategy::Accepted() {
+    if (_attemptSubBand < 1 || _attemptSubBand > JOIN_STRATEGY_SUB_BANDS) {
+        return false;
+    }
+
+    uint8_t& accepted = _history.Accepted[_attemptSubBand - 1];
+
+    // Keep counts relative to each other when one saturates
+    if (accepted == UINT8_MAX) {
+        for (uint8_t i = 0; i < JOIN_STRATEGY_SUB_BANDS; i++) {
+            _history.Accepted[i] /= 2;
+        }
+    }
+
+    accepted++;
+    _history.Last = _attemptSubBand;
+    _history.Datarate = _attemptDatarate;
+    _attemptSubBand = 0;
+
+    Sort();
+
+    return true;
+}
+
+bool JoinStrategy::SetHistory(const History& history) {
+    if (history.Magic != JOIN_STRATEGY_MAGIC || history.Last > JOIN_STRATEGY_SUB_BANDS) {
+        return false;
+    }
+
+    _history = history;
+    Sort();
+
+    return true;
+}
+
+void JoinStrategy::Sort() {
+    uint8_t n = 0;
+
+    if (_history.Last != 0) {
+        _order[n++] = _history.Last;
+    }
+
+    // Insertion sort by joins accepted, ties stay in numeric order
+    for (uint8_t band = 1; band <= JOIN_STRATEGY_SUB_BANDS; band++) {
+        if (band == _history.Last) {
+            continue;
+        }
+
+        uint8_t i = n++;
+        uint8_t start = _history.Last != 0 ? 1 : 0;
+
+        while (i > start && _history.Accepted[_order[i - 1] - 1] < _history.Accepted[band - 1]) {
+            _order[i] = _order[i - 1];
+            i--;
+        }
+
+        _order[i] = band;
+    }
+}
@@ -0,0 +1,107 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#ifndef __JOIN_STRATEGY_H__
+#define __JOIN_STRATEGY_H__
+
+#include <stdint.h>
+
+namespace lora {
+
+    const uint8_t JOIN_STRATEGY_SUB_BANDS = 8;                  //!< Sub-bands of the US915 and AU915 plans
+    const uint8_t JOIN_STRATEGY_MAGIC = 0x5A;                   //!< Marks saved history as valid
+    const uint8_t JOIN_STRATEGY_NO_DATARATE = 0xFF;             //!< No join accepted yet
+
+    /**
+     * Order of sub-bands to search when joining without a configured sub-band.
+     *
+     * The sub-band and datarate of the last join accept are tried first, then
+     * the remaining sub-bands by number of joins accepted on each, then the
+     * rest in numeric order.  The history is small enough to save in a user
+     * file so it survives a reset.
+     */
+    class JoinStrategy {
+        public:
+            /**
+             * Join history saved between resets
+             */
+            struct History {
+                uint8_t Magic;                                  //!< JOIN_STRATEGY_MAGIC when valid
+                uint8_t Last;                                   //!< Sub-band of the last join accept, 0 for none
+                uint8_t Datarate;                               //!< Datarate of the last join accept
+                uint8_t Accepted[JOIN_STRATEGY_SUB_BANDS];      //!< Joins accepted on each sub-band
+            };
+
+            JoinStrategy();
+
+            /**
+             * Forget join history
+             */
+            void Reset();
+
+            /**
+             * Get the sub-band to try at a position in the search
+             * @param n position 0-7
+             * @return sub-band 1-8
+             */
+            uint8_t SubBand(uint8_t n) const;
+
+            /**
+             * Datarate of the last join accept
+             * @return datarate or JOIN_STRATEGY_NO_DATARATE
+             */
+            uint8_t Datarate() const { return _history.Datarate; }
+
+            /**
+             * Record the sub-band and datarate of a join request
+             * @param sub_band 1-8
+             * @param datarate of join request
+             */
+            void Attempt(uint8_t sub_band, uint8_t datarate);
+
+            /**
+             * Record a join accept for the last join request
+             * @return true if the history changed and should be saved
+             */
+            bool Accepted();
+
+            /**
+             * Get history for saving
+             */
+            const History& GetHistory() const { return _history; }
+
+            /**
+             * Restore saved history
+             * @param history loaded history
+             * @return true if the history was valid
+             */
+            bool SetHistory(const History& history);
+
+        private:
+            void Sort();
+
+            History _history;
+            uint8_t _order[JOIN_STRATEGY_SUB_BANDS];
+            uint8_t _attemptSubBand;
+            uint8_t _attemptDatarate;
+    };
+
+    extern JoinStrategy join_strategy;
+
+} // namespace lora
+
+#endif
@@ -0,0 +1,74 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#include "RxConfigCache.h"
+#include <string.h>
+
+using namespace lora;
+
+RxConfigCache::RxConfigCache()
+:
+  _valid(false),
+  _hits(0),
+  _misses(0)
+{
+    memset(&_key, 0, sizeof(_key));
+    memset(_regs, 0, sizeof(_regs));
+}
+
+bool RxConfigCache::Current(SxRadio* radio, const RxConfigKey& key) {
+    if (!_valid || !Equal(key, _key)) {
+        _misses++;
+        return false;
+    }
+
+    uint8_t regs[RX_CONFIG_SNAPSHOT_SIZE];
+    Snapshot(radio, regs);
+
+    if (memcmp(regs, _regs, sizeof(regs)) != 0) {
+        // Radio was reconfigured outside the plan
+        _valid = false;
+        _misses++;
+        return false;
+    }
+
+    _hits++;
+    return true;
+}
+
+void RxConfigCache::Applied(SxRadio* radio, const RxConfigKey& key) {
+    if (!key.Continuous) {
+        // Single windows change with every uplink, not worth the register reads
+        _valid = false;
+        return;
+    }
+
+    _key = key;
+    Snapshot(radio, _regs);
+    _valid = true;
+}
+
+void RxConfigCache::Snapshot(SxRadio* radio, uint8_t* regs) {
+    regs[0] = radio->Read(RX_CONFIG_REG_OP_MODE) & 0x80;
+    radio->ReadBuffer(RX_CONFIG_REG_FRF, &regs[1], 3);
+    radio->ReadBuffer(RX_CONFIG_REG_MODEM_CONFIG, &regs[4], 2);
+}
+
+bool RxConfigCache::Equal(const RxConfigKey& a, const RxConfigKey& b) {
+    return a.Frequency == b.Frequency && a.Growth == b.Growth && a.Pad == b.Pad && a.Window == b.Window
+           && a.Datarate == b.Datarate && a.Id == b.Id && a.Continuous == b.Continuous;
+}
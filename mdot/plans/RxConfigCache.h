@@ -0,0 +1,102 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#ifndef __RX_CONFIG_CACHE_H__
+#define __RX_CONFIG_CACHE_H__
+
+#include "Lora.h"
+#include "SxRadio.h"
+
+namespace lora {
+
+    const uint8_t RX_CONFIG_REG_OP_MODE = 0x01;                 //!< Operating mode, bit 7 selects LoRa
+    const uint8_t RX_CONFIG_REG_FRF = 0x06;                     //!< First of three carrier frequency registers
+    const uint8_t RX_CONFIG_REG_MODEM_CONFIG = 0x1D;            //!< First of two bandwidth, coderate and spreading factor registers
+    const uint8_t RX_CONFIG_SNAPSHOT_SIZE = 6;                  //!< Registers compared before a configuration is reused
+
+    /**
+     * Receive window configuration requested from the plan
+     */
+    typedef struct {
+            uint32_t Frequency;         //!< Frequency of the window
+            uint16_t Growth;            //!< Window growth factor
+            uint16_t Pad;               //!< Window padding in ms
+            uint8_t Window;             //!< RX_1, RX_2, RX_SLOT, RX_BEACON or RXC
+            uint8_t Datarate;           //!< Datarate index of the window
+            int8_t Id;                  //!< Multicast session of the window
+            bool Continuous;            //!< Window is kept open
+    } RxConfigKey;
+
+    /**
+     * Skips radio reconfiguration when a continuous receive window is opened
+     * again with the configuration the radio already holds.
+     *
+     * Class C reopens the same window after every downlink, each time paying
+     * a full SetRxConfig over SPI.  The cache keeps the last continuous
+     * window configured and a snapshot of the modem, frequency and bandwidth
+     * registers read back after it was applied.  A reopen is skipped only
+     * while the request and the registers still match.  Plans invalidate the
+     * cache whenever the radio is configured for transmit.
+     */
+    class RxConfigCache {
+        public:
+            RxConfigCache();
+
+            /**
+             * Forget the cached configuration
+             */
+            void Invalidate() { _valid = false; }
+
+            /**
+             * Check if the radio still holds a receive configuration
+             * @param radio to check
+             * @param key window configuration requested
+             * @return true if the configuration can be skipped
+             */
+            bool Current(SxRadio* radio, const RxConfigKey& key);
+
+            /**
+             * Record a receive configuration just applied to the radio
+             * @param radio configured
+             * @param key window configuration applied
+             */
+            void Applied(SxRadio* radio, const RxConfigKey& key);
+
+            /**
+             * Configurations skipped
+             */
+            uint32_t Hits() const { return _hits; }
+
+            /**
+             * Configurations applied
+             */
+            uint32_t Misses() const { return _misses; }
+
+        private:
+            static void Snapshot(SxRadio* radio, uint8_t* regs);
+            static bool Equal(const RxConfigKey& a, const RxConfigKey& b);
+
+            RxConfigKey _key;
+            uint8_t _regs[RX_CONFIG_SNAPSHOT_SIZE];
+            bool _valid;
+            uint32_t _hits;
+            uint32_t _misses;
+    };
+
+} // namespace lora
+
+#endif
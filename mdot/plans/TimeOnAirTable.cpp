@@ -0,0 +1,30 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#include "TimeOnAirTable.h"
+
+using namespace lora;
+
+// Only the LoRa uplink datarates used by the plans, about 0.5 KB each
+constexpr TimeOnAirRow lora::TIME_ON_AIR_SF7_BW125(SF_7, BW_125);
+constexpr TimeOnAirRow lora::TIME_ON_AIR_SF8_BW125(SF_8, BW_125);
+constexpr TimeOnAirRow lora::TIME_ON_AIR_SF9_BW125(SF_9, BW_125);
+constexpr TimeOnAirRow lora::TIME_ON_AIR_SF10_BW125(SF_10, BW_125);
+constexpr TimeOnAirRow lora::TIME_ON_AIR_SF11_BW125(SF_11, BW_125);
+constexpr TimeOnAirRow lora::TIME_ON_AIR_SF12_BW125(SF_12, BW_125);
+constexpr TimeOnAirRow lora::TIME_ON_AIR_SF7_BW250(SF_7, BW_250);
+constexpr TimeOnAirRow lora::TIME_ON_AIR_SF8_BW500(SF_8, BW_500);
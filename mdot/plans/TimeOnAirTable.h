@@ -0,0 +1,189 @@
+/**********************************************************************
+* COPYRIGHT 2021 MULTI-TECH SYSTEMS, INC.
+*
+* ALL RIGHTS RESERVED BY AND FOR THE EXCLUSIVE BENEFIT OF
+* MULTI-TECH SYSTEMS, INC.
+*
+* MULTI-TECH SYSTEMS, INC. - CONFIDENTIAL AND PROPRIETARY
+* INFORMATION AND/OR TRADE SECRET.
+*
+* NOTICE: ALL CODE, PROGRAM, INFORMATION, SCRIPT, INSTRUCTION,
+* DATA, AND COMMENT HEREIN IS AND SHALL REMAIN THE CONFIDENTIAL
+* INFORMATION AND PROPERTY OF MULTI-TECH SYSTEMS, INC.
+* USE AND DISCLOSURE THEREOF, EXCEPT AS STRICTLY AUTHORIZED IN A
+* WRITTEN AGREEMENT SIGNED BY MULTI-TECH SYSTEMS, INC. IS PROHIBITED.
+*
+***********************************************************************/
+
+#ifndef __TIME_ON_AIR_TABLE_H__
+#define __TIME_ON_AIR_TABLE_H__
+
+#include "Lora.h"
+
+namespace lora {
+
+    const uint16_t TIME_ON_AIR_TABLE_LENGTHS = 256;             //!< Payload lengths 0-255 are covered
+
+    /**
+     * LoRa symbol time in us, exact for 125, 250 and 500 kHz bandwidth
+     * @param sf spreading factor
+     * @param bw bandwidth
+     */
+    constexpr uint32_t LoRaSymbolTimeUs(uint8_t sf, uint8_t bw) {
+        return (1UL << sf) * (bw == BW_500 ? 2 : (bw == BW_250 ? 4 : 8));
+    }
+
+    /**
+     * Time on air in us of a LoRa packet with explicit header using integer math only
+     * @param sf spreading factor
+     * @param bw bandwidth
+     * @param bytes PHY payload length
+     * @param coderate 1-4 for 4/5 to 4/8
+     * @param preamble preamble length in symbols
+     * @param crc payload CRC enabled
+     */
+    constexpr uint32_t LoRaTimeOnAirUs(uint8_t sf, uint8_t bw, uint8_t bytes, uint8_t coderate = 1, uint8_t preamble = 8, bool crc = true) {
+        // Low datarate optimize is used when the symbol time reaches 16 ms
+        uint8_t de = LoRaSymbolTimeUs(sf, bw) >= 16000 ? 2 : 0;
+        int32_t bits = 8 * bytes - 4 * sf + 28 + (crc ? 16 : 0);
+        int32_t per_block = 4 * (sf - de);
+        uint32_t blocks = bits > 0 ? (bits + per_block - 1) / per_block : 0;
+        uint32_t symbols = 8 + blocks * (coderate + 4);
+
+        // preamble adds 4.25 symbols for sync word and start of frame
+        return LoRaSymbolTimeUs(sf, bw) * (4 * preamble + 17) / 4 + symbols * LoRaSymbolTimeUs(sf, bw);
+    }
+
+    /**
+     * Time on air rounded up to ms the same way as SxRadio::TimeOnAir
+     */
+    constexpr uint32_t LoRaTimeOnAirMs(uint8_t sf, uint8_t bw, uint8_t bytes) {
+        return (LoRaTimeOnAirUs(sf, bw, bytes) + 999) / 1000;
+    }
+
+    // Checked against the floating point formula
+    static_assert(LoRaTimeOnAirMs(SF_7, BW_125, 13) == 47, "SF7BW125 time on air");
+    static_assert(LoRaTimeOnAirMs(SF_12, BW_125, 23) == 1483, "SF12BW125 time on air");
+    static_assert(LoRaTimeOnAirMs(SF_11, BW_125, 242) == 4756, "SF11BW125 time on air");
+    static_assert(LoRaTimeOnAirMs(SF_12, BW_250, 50) == 1151, "SF12BW250 time on air");
+    static_assert(LoRaTimeOnAirMs(SF_7, BW_250, 255) == 200, "SF7BW250 time on air");
+    static_assert(LoRaTimeOnAirMs(SF_8, BW_500, 23) == 29, "SF8BW500 time on air");
+    static_assert(LoRaTimeOnAirMs(SF_9, BW_125, 0) == 104, "SF9BW125 time on air");
+
+    /**
+     * Time on air in ms of one LoRa spreading factor and bandwidth, indexed by
+     * PHY payload length and built at compile time.
+     *
+     * Covers the usual uplink settings: coding rate 4/5, 8 symbol preamble and
+     * CRC on.  One row exists per spreading factor and bandwidth and is shared
+     * by every plan using it.
+     */
+    class TimeOnAirRow {
+        public:
+            /**
+             * Build the row
+             * @param sf spreading factor
+             * @param bw bandwidth
+             */
+            constexpr TimeOnAirRow(uint8_t sf, uint8_t bw) : _sf(sf), _bw(bw), _ms() {
+                for (uint16_t len = 0; len < TIME_ON_AIR_TABLE_LENGTHS; len++) {
+                    _ms[len] = LoRaTimeOnAirMs(sf, bw, len);
+                }
+            }
+
+            /**
+             * Get time on air
+             * @param datarate settings used for transmit
+             * @param bytes PHY payload length
+             * @param [out] ms time on air in ms
+             * @return true if the datarate settings match the row
+             */
+            bool Lookup(const Datarate& datarate, uint8_t bytes, uint32_t& ms) const {
+                if (_sf != datarate.SpreadingFactor || _bw != datarate.Bandwidth
+                    || datarate.Coderate != 1 || datarate.PreambleLength != 8 || !datarate.Crc) {
+                    return false;
+                }
+
+                ms = _ms[bytes];
+                return true;
+            }
+
+            /**
+             * Get time on air
+             * @param bytes PHY payload length
+             * @return time on air in ms
+             */
+            constexpr uint16_t Get(uint8_t bytes) const {
+                return _ms[bytes];
+            }
+
+        private:
+            uint8_t _sf;
+            uint8_t _bw;
+            uint16_t _ms[TIME_ON_AIR_TABLE_LENGTHS];
+    };
+
+    // Shared rows, defined in TimeOnAirTable.cpp so each is linked in once
+    extern const TimeOnAirRow TIME_ON_AIR_SF7_BW125;
+    extern const TimeOnAirRow TIME_ON_AIR_SF8_BW125;
+    extern const TimeOnAirRow TIME_ON_AIR_SF9_BW125;
+    extern const TimeOnAirRow TIME_ON_AIR_SF10_BW125;
+    extern const TimeOnAirRow TIME_ON_AIR_SF11_BW125;
+    extern const TimeOnAirRow TIME_ON_AIR_SF12_BW125;
+    extern const TimeOnAirRow TIME_ON_AIR_SF7_BW250;
+    extern const TimeOnAirRow TIME_ON_AIR_SF8_BW500;
+
+    /**
+     * Uplink time on air for each LoRa datarate of a channel plan
+     *
+     * Maps datarate index to a shared row.  Lookup fails for a NULL row or
+     * other datarate settings so the caller can fall back to the radio
+     * calculation.
+     */
+    template <uint8_t N>
+    class TimeOnAirTable {
+        public:
+            /**
+             * Build the table from the datarates of a plan, use NULL for FSK or unused datarates
+             * @param rows shared row of each datarate
+             */
+            constexpr TimeOnAirTable(const TimeOnAirRow* const (&rows)[N]) : _rows() {
+                for (uint8_t i = 0; i < N; i++) {
+                    _rows[i] = rows[i];
+                }
+            }
+
+            /**
+             * Get time on air
+             * @param datarate settings used for transmit
+             * @param bytes PHY payload length
+             * @param [out] ms time on air in ms
+             * @return true if the datarate is covered by the table
+             */
+            bool Lookup(const Datarate& datarate, uint8_t bytes, uint32_t& ms) const {
+                uint8_t i = datarate.Index;
+
+                if (i >= N || _rows[i] == NULL) {
+                    return false;
+                }
+
+                return _rows[i]->Lookup(datarate, bytes, ms);
+            }
+
+            /**
+             * Get time on air of a datarate index
+             * @param index datarate index
+             * @param bytes PHY payload length
+             * @return time on air in ms or 0 if not covered
+             */
+            constexpr uint16_t Get(uint8_t index, uint8_t bytes) const {
+                return index < N && _rows[index] != NULL ? _rows[index]->Get(bytes) : 0;
+            }
+
+        private:
+            const TimeOnAirRow* _rows[N];
+    };
+
+} // namespace lora
+
+#endif